@@ -0,0 +1,160 @@
+#include "fft.hpp"
+#include "dft.hpp"
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include <complex>
+#include <iomanip>
+#include <iostream>
+#include <functional>
+
+//Measures the error of every transform engine against a long double reference
+//and checks that the error of the fast transforms grows like O(log N).
+
+using reference_vec = std::vector<std::complex<long double>>;
+
+//radix-2 transform with every twiddle computed directly in long double
+reference_vec reference_fft(reference_vec input)
+{
+    static const long double pi = 3.141592653589793238462643383279502884L;
+    auto size = input.size();
+    for (size_t i = 1, j = 0; i < size; ++i)
+    {
+        auto bit = size >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) std::swap(input[i], input[j]);
+    }
+    for (size_t half = 1; half < size; half *= 2)
+    {
+        for (size_t j = 0; j < half; ++j)
+        {
+            auto angle = -pi * (long double)(j) / (long double)(half);
+            std::complex<long double> twiddle(std::cos(angle), std::sin(angle));
+            for (size_t block = 0; block < size; block += 2 * half)
+            {
+                auto t = input[block + j + half] * twiddle;
+                input[block + j + half] = input[block + j] - t;
+                input[block + j] += t;
+            }
+        }
+    }
+    return input;
+}
+
+struct engine
+{
+    std::string name;
+    size_t max_size;
+    long double epsilon;
+    bool inverse;
+    bool check_growth;
+    std::function<reference_vec(const reference_vec&)> run;
+};
+
+template <typename T, typename Transform>
+engine make_engine(std::string name, size_t max_size, bool inverse, bool check_growth, Transform transform)
+{
+    auto run = [transform](const reference_vec& input) {
+        std::vector<std::complex<T>> converted(input.size());
+        for (auto i = 0u; i < input.size(); ++i)
+            converted[i] = std::complex<T>(T(input[i].real()), T(input[i].imag()));
+        auto result = transform(converted);
+        reference_vec ret(result.size());
+        for (auto i = 0u; i < result.size(); ++i)
+            ret[i] = std::complex<long double>(result[i].real(), result[i].imag());
+        return ret;
+    };
+    return {name, max_size, std::numeric_limits<T>::epsilon(), inverse, check_growth, run};
+}
+
+template <typename T>
+reference_vec rounded_input(size_t size, std::mt19937& rd)
+{
+    std::uniform_real_distribution<double> dist(-0.5, 0.5);
+    reference_vec ret(size);
+    for (auto& elem : ret)
+        elem = std::complex<long double>(T(dist(rd)), T(dist(rd)));
+    return ret;
+}
+
+int main()
+{
+    std::vector<engine> engines = {
+        make_engine<float>("fft<float>", 1 << 20, false, true,
+            [](fft::ComplexVec<float> arg) { return fft::fft(arg); }),
+        make_engine<double>("fft<double>", 1 << 20, false, true,
+            [](fft::ComplexVec<double> arg) { return fft::fft(arg); }),
+        make_engine<float>("inv_fft<float>", 1 << 20, true, true,
+            [](fft::ComplexVec<float> arg) { return fft::inv_fft(arg); }),
+        make_engine<double>("inv_fft<double>", 1 << 20, true, true,
+            [](fft::ComplexVec<double> arg) { return fft::inv_fft(arg); }),
+        make_engine<float>("dft<float>", 1 << 9, false, false,
+            [](fft::ComplexVec<float> arg) { return dft::dft(arg); }),
+        make_engine<double>("dft<double>", 1 << 9, false, false,
+            [](fft::ComplexVec<double> arg) { return dft::dft(arg); }),
+    };
+
+    std::mt19937 rd;
+    auto failures = 0u;
+    std::cout << std::left << std::setw(18) << "engine" << std::right << std::setw(10) << "N"
+              << std::setw(14) << "rms rel" << std::setw(14) << "max rel"
+              << std::setw(18) << "rms/(eps log2 N)" << std::endl;
+
+    for (auto& current : engines)
+    {
+        long double first_normalized = 0, worst_normalized = 0;
+        for (size_t size = 16; size <= current.max_size; size *= 4)
+        {
+            auto input = (current.epsilon > std::numeric_limits<double>::epsilon())
+                ? rounded_input<float>(size, rd) : rounded_input<double>(size, rd);
+
+            auto reference = input;
+            if (current.inverse)
+            {
+                //inverse transform is the conjugated forward transform of the conjugate, scaled
+                for (auto& elem : reference) elem = std::conj(elem);
+                reference = reference_fft(reference);
+                for (auto& elem : reference) elem = std::conj(elem) / (long double)(size);
+            }
+            else
+            {
+                reference = reference_fft(reference);
+            }
+            auto result = current.run(input);
+
+            long double error_energy = 0, reference_energy = 0, max_error = 0;
+            for (auto i = 0u; i < size; ++i)
+            {
+                auto error = std::abs(result[i] - reference[i]);
+                error_energy += error * error;
+                reference_energy += std::norm(reference[i]);
+                max_error = std::max(max_error, error);
+            }
+            auto reference_rms = std::sqrt(reference_energy / size);
+            auto rms = std::sqrt(error_energy / reference_energy);
+            auto max = max_error / reference_rms;
+            auto normalized = rms / (current.epsilon * std::log2((long double)(size)));
+
+            if (size == 16) first_normalized = normalized;
+            worst_normalized = std::max(worst_normalized, normalized);
+
+            std::cout << std::left << std::setw(18) << current.name << std::right
+                      << std::setw(10) << size << std::scientific << std::setprecision(3)
+                      << std::setw(14) << double(rms) << std::setw(14) << double(max)
+                      << std::fixed << std::setw(18) << double(normalized) << std::endl;
+        }
+
+        //O(log N) growth keeps the error per eps log2 N roughly constant
+        auto grows_too_fast = worst_normalized > 4 * std::max(first_normalized, 0.25L);
+        if (current.check_growth and grows_too_fast)
+        {
+            ++failures;
+            std::cout << current.name << ": error grows faster than O(log N)" << std::endl;
+        }
+    }
+
+    return (failures > 0) ? 1 : 0;
+}
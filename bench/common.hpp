@@ -0,0 +1,41 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+#include <complex>
+#include <cmath>
+
+template <typename T>
+std::vector<T> random_real(size_t size)
+{
+    static std::mt19937 rd;
+    std::uniform_real_distribution<T> dist(T(-1), T(1));
+    std::vector<T> ret(size);
+    for (auto& elem : ret) elem = dist(rd);
+    return ret;
+}
+
+template <typename T>
+std::vector<std::complex<T>> random_complex(size_t size)
+{
+    auto re = random_real<T>(size);
+    auto im = random_real<T>(size);
+    std::vector<std::complex<T>> ret(size);
+    for (auto i = 0u; i < size; ++i)
+        ret[i] = std::complex<T>(re[i], im[i]);
+    return ret;
+}
+
+//ns per transform is the reported time per iteration; MFLOPS follow the 5 N log2 N
+//convention for an N point complex transform and bytes count one read and one write
+//of every stored Element
+template <typename T, typename Element = std::complex<T>>
+void report_transform(benchmark::State& state, size_t size)
+{
+    auto flops = 5.0 * size * std::log2(double(size));
+    state.counters["MFLOPS"] = benchmark::Counter(
+        flops * 1.0e-6, benchmark::Counter::kIsIterationInvariantRate);
+    state.SetBytesProcessed(int64_t(state.iterations()) * 2 * size * sizeof(Element));
+    state.SetItemsProcessed(state.iterations());
+}
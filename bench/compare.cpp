@@ -0,0 +1,62 @@
+#include "regression.hpp"
+#include <iostream>
+#include <iomanip>
+
+//Compares a benchmark report against a stored baseline; exits with 1 when any
+//benchmark got significantly (Mann-Whitney, p < alpha) and noticeably slower.
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage: " << argv[0]
+                  << " baseline.json current.json [alpha=0.05] [min_slowdown=0.05]" << std::endl;
+        return 2;
+    }
+    auto alpha = (argc > 3) ? std::atof(argv[3]) : 0.05;
+    auto min_slowdown = (argc > 4) ? std::atof(argv[4]) : 0.05;
+
+    std::map<std::string, std::vector<double>> baseline, current;
+    try
+    {
+        baseline = regression::load_samples(argv[1]);
+        current = regression::load_samples(argv[2]);
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << error.what() << std::endl;
+        return 2;
+    }
+
+    auto regressions = 0u;
+    std::cout << std::left << std::setw(48) << "benchmark" << std::right
+              << std::setw(14) << "baseline ns" << std::setw(14) << "current ns"
+              << std::setw(10) << "change" << std::setw(10) << "p" << std::endl;
+    for (auto& entry : current)
+    {
+        auto found = baseline.find(entry.first);
+        if (found == baseline.end())
+        {
+            std::cout << std::left << std::setw(48) << entry.first << "  not in baseline" << std::endl;
+            continue;
+        }
+
+        auto before = regression::median(found->second);
+        auto after = regression::median(entry.second);
+        auto change = after / before - 1;
+        auto p = regression::slowdown_p_value(found->second, entry.second);
+        auto regressed = (p < alpha) and (change > min_slowdown);
+        if ((found->second.size() < 3) or (entry.second.size() < 3))
+            regressed = false;
+        regressions += regressed;
+
+        std::cout << std::left << std::setw(48) << entry.first << std::right << std::fixed
+                  << std::setw(14) << std::setprecision(1) << before
+                  << std::setw(14) << after
+                  << std::setw(9) << std::setprecision(1) << change * 100 << "%"
+                  << std::setw(10) << std::setprecision(4) << p
+                  << (regressed ? "  SLOWER" : "") << std::endl;
+    }
+
+    std::cout << regressions << " significant slowdown(s)" << std::endl;
+    return (regressions > 0) ? 1 : 0;
+}
@@ -0,0 +1,35 @@
+#include "common.hpp"
+#include "convolution.hpp"
+
+//bytes and MFLOPS are those of the padded transform convolve performs
+template <typename T>
+void BM_convolve(benchmark::State& state)
+{
+    auto input = random_real<T>(state.range(0));
+    auto kernel = random_real<T>(state.range(1));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(convolution::convolve(input, kernel));
+    report_transform<T>(state, convolution::detail::nearest_power_of_2(input.size() + kernel.size()));
+}
+
+template <typename T>
+void BM_convolve_2d(benchmark::State& state)
+{
+    auto width = state.range(0);
+    auto kernel_width = state.range(1);
+    auto input = random_real<T>(width * width);
+    auto kernel = random_real<T>(kernel_width * kernel_width);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(convolution::convolve_2d(input, width, kernel, kernel_width));
+    auto padded = (width + kernel_width) * (width + kernel_width);
+    report_transform<T>(state, convolution::detail::nearest_power_of_2(padded));
+}
+
+#define CONVOLUTION_SIZES \
+    Args({1000, 31})->Args({1024, 32})->Args({4096, 255})->Args({65536, 1024})->Args({100000, 999})
+#define CONVOLUTION_2D_SIZES Args({100, 5})->Args({128, 8})->Args({500, 21})->Args({512, 64})
+
+BENCHMARK_TEMPLATE(BM_convolve, float)->CONVOLUTION_SIZES;
+BENCHMARK_TEMPLATE(BM_convolve, double)->CONVOLUTION_SIZES;
+BENCHMARK_TEMPLATE(BM_convolve_2d, float)->CONVOLUTION_2D_SIZES;
+BENCHMARK_TEMPLATE(BM_convolve_2d, double)->CONVOLUTION_2D_SIZES;
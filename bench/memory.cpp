@@ -0,0 +1,54 @@
+#include "common.hpp"
+#include "fft.hpp"
+#include "memory.hpp"
+
+//Large in place transforms over buffers and workspaces mapped with every page policy;
+//without reserved huge pages explicit_huge measures the transparent fallback.
+
+template <memory::page_policy policy>
+memory::huge_vector<std::complex<float>> large_buffer(size_t size)
+{
+    auto values = random_complex<float>(size);
+    memory::huge_vector<std::complex<float>> ret(
+        values.begin(), values.end(), memory::huge_page_allocator<std::complex<float>>(policy));
+    return ret;
+}
+
+template <memory::page_policy policy>
+void BM_large_fft(benchmark::State& state)
+{
+    auto size = size_t(state.range(0));
+    auto data = large_buffer<policy>(size);
+    fft::plan<float> transform(size);
+    for (auto _ : state)
+    {
+        transform.execute(data.data(), false);
+        benchmark::ClobberMemory();
+    }
+    report_transform<float>(state, size);
+}
+
+template <memory::page_policy policy>
+void BM_large_fft_2d(benchmark::State& state)
+{
+    auto width = size_t(state.range(0)), height = size_t(state.range(1));
+    auto data = large_buffer<policy>(width * height);
+    auto previous = memory::current_page_policy();
+    memory::set_page_policy(policy);
+    memory::thread_pool().trim();
+    for (auto _ : state)
+    {
+        fft::fft_2d_in_place(data.data(), width, height);
+        benchmark::ClobberMemory();
+    }
+    memory::set_page_policy(previous);
+    memory::thread_pool().trim();
+    report_transform<float>(state, width * height);
+}
+
+BENCHMARK_TEMPLATE(BM_large_fft, memory::page_policy::normal)->Arg(1 << 22);
+BENCHMARK_TEMPLATE(BM_large_fft, memory::page_policy::transparent)->Arg(1 << 22);
+BENCHMARK_TEMPLATE(BM_large_fft, memory::page_policy::explicit_huge)->Arg(1 << 22);
+BENCHMARK_TEMPLATE(BM_large_fft_2d, memory::page_policy::normal)->Args({2048, 2048});
+BENCHMARK_TEMPLATE(BM_large_fft_2d, memory::page_policy::transparent)->Args({2048, 2048});
+BENCHMARK_TEMPLATE(BM_large_fft_2d, memory::page_policy::explicit_huge)->Args({2048, 2048});
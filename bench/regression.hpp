@@ -0,0 +1,251 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+namespace regression
+{
+
+//just enough of JSON to read the files written by --benchmark_out_format=json
+struct json
+{
+    enum class kind { null, boolean, number, string, array, object };
+
+    kind type = kind::null;
+    double number = 0;
+    std::string text;
+    std::vector<json> items;
+    std::vector<std::pair<std::string, json>> members;
+
+    const json* find(const std::string& key) const
+    {
+        for (auto& member : members)
+            if (member.first == key) return &member.second;
+        return nullptr;
+    }
+};
+
+namespace detail
+{
+
+class parser
+{
+public:
+    explicit parser(const std::string& input) : input_(input), position_(0) {}
+
+    json parse()
+    {
+        auto ret = value();
+        skip_spaces();
+        if (position_ != input_.size()) fail("trailing characters");
+        return ret;
+    }
+
+private:
+    [[noreturn]] void fail(const std::string& what) const
+    {
+        throw std::runtime_error("invalid json at " + std::to_string(position_) + ": " + what);
+    }
+
+    void skip_spaces()
+    {
+        while ((position_ < input_.size()) and std::isspace((unsigned char)input_[position_]))
+            ++position_;
+    }
+
+    bool consume(char expected)
+    {
+        skip_spaces();
+        if ((position_ >= input_.size()) or (input_[position_] != expected)) return false;
+        ++position_;
+        return true;
+    }
+
+    void expect(char expected)
+    {
+        if (not consume(expected)) fail(std::string("expected ") + expected);
+    }
+
+    bool consume_word(const std::string& word)
+    {
+        if (input_.compare(position_, word.size(), word) != 0) return false;
+        position_ += word.size();
+        return true;
+    }
+
+    std::string string()
+    {
+        expect('"');
+        std::string ret;
+        while ((position_ < input_.size()) and (input_[position_] != '"'))
+        {
+            auto c = input_[position_++];
+            if ((c == '\\') and (position_ < input_.size()))
+            {
+                auto escaped = input_[position_++];
+                if (escaped == 'n') c = '\n';
+                else if (escaped == 't') c = '\t';
+                else if (escaped == 'u') { position_ += 4; c = '?'; }
+                else c = escaped;
+            }
+            ret += c;
+        }
+        expect('"');
+        return ret;
+    }
+
+    json value()
+    {
+        skip_spaces();
+        if (position_ >= input_.size()) fail("unexpected end");
+
+        json ret;
+        auto c = input_[position_];
+        if (c == '{')
+        {
+            ret.type = json::kind::object;
+            expect('{');
+            if (consume('}')) return ret;
+            do
+            {
+                skip_spaces();
+                auto key = string();
+                expect(':');
+                ret.members.emplace_back(key, value());
+            } while (consume(','));
+            expect('}');
+        }
+        else if (c == '[')
+        {
+            ret.type = json::kind::array;
+            expect('[');
+            if (consume(']')) return ret;
+            do
+                ret.items.push_back(value());
+            while (consume(','));
+            expect(']');
+        }
+        else if (c == '"')
+        {
+            ret.type = json::kind::string;
+            ret.text = string();
+        }
+        else if (consume_word("true"))
+        {
+            ret.type = json::kind::boolean;
+            ret.number = 1;
+        }
+        else if (consume_word("false"))
+        {
+            ret.type = json::kind::boolean;
+        }
+        else if (consume_word("null"))
+        {
+            ret.type = json::kind::null;
+        }
+        else
+        {
+            char* end = nullptr;
+            ret.type = json::kind::number;
+            ret.number = std::strtod(input_.c_str() + position_, &end);
+            if (end == input_.c_str() + position_) fail("unexpected character");
+            position_ = end - input_.c_str();
+        }
+        return ret;
+    }
+
+    const std::string& input_;
+    size_t position_;
+};
+
+inline double nanoseconds(const std::string& unit)
+{
+    if (unit == "ns") return 1.0;
+    if (unit == "us") return 1.0e3;
+    if (unit == "ms") return 1.0e6;
+    if (unit == "s") return 1.0e9;
+    throw std::runtime_error("unknown time unit " + unit);
+}
+
+} //namespace detail
+
+inline json parse(const std::string& input)
+{
+    return detail::parser(input).parse();
+}
+
+//real time in ns of every repetition of every benchmark in a Google Benchmark json report
+inline std::map<std::string, std::vector<double>> load_samples(const std::string& path)
+{
+    std::ifstream file(path);
+    if (not file) throw std::runtime_error("cannot open " + path);
+    std::stringstream content;
+    content << file.rdbuf();
+
+    std::map<std::string, std::vector<double>> ret;
+    auto report = parse(content.str());
+    auto benchmarks = report.find("benchmarks");
+    if (benchmarks == nullptr) throw std::runtime_error(path + " is not a benchmark report");
+    for (auto& run : benchmarks->items)
+    {
+        auto type = run.find("run_type");
+        if ((type != nullptr) and (type->text != "iteration")) continue;
+        auto name = run.find("run_name");
+        if (name == nullptr) name = run.find("name");
+        auto time = run.find("real_time");
+        auto unit = run.find("time_unit");
+        if ((name == nullptr) or (time == nullptr)) continue;
+        ret[name->text].push_back(time->number * detail::nanoseconds(unit ? unit->text : "ns"));
+    }
+    return ret;
+}
+
+inline double median(std::vector<double> samples)
+{
+    std::sort(samples.begin(), samples.end());
+    auto middle = samples.size() / 2;
+    if (samples.size() % 2 == 1) return samples[middle];
+    return (samples[middle - 1] + samples[middle]) / 2;
+}
+
+//One sided Mann-Whitney U test with the normal approximation (tie and continuity
+//corrected); returns the probability of current being at least this much slower
+//than baseline if both came from the same distribution.
+inline double slowdown_p_value(const std::vector<double>& baseline, const std::vector<double>& current)
+{
+    std::vector<std::pair<double, bool>> all;
+    for (auto value : baseline) all.emplace_back(value, false);
+    for (auto value : current) all.emplace_back(value, true);
+    std::sort(all.begin(), all.end());
+
+    double n1 = baseline.size(), n2 = current.size(), n = n1 + n2;
+    double current_ranks = 0, ties = 0;
+    for (auto first = 0u; first < all.size();)
+    {
+        auto last = first;
+        while ((last < all.size()) and (all[last].first == all[first].first)) ++last;
+        double count = last - first;
+        auto rank = (first + 1 + last) / 2.0;
+        for (auto i = first; i < last; ++i)
+            if (all[i].second) current_ranks += rank;
+        ties += count * count * count - count;
+        first = last;
+    }
+
+    auto u = current_ranks - n2 * (n2 + 1) / 2;
+    auto variance = n1 * n2 / 12.0 * ((n + 1) - ties / (n * (n - 1)));
+    if (variance <= 0) return 1.0;
+    auto z = (u - n1 * n2 / 2 - 0.5) / std::sqrt(variance);
+    return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+} //namespace regression
@@ -0,0 +1,122 @@
+#include "common.hpp"
+#include "fft.hpp"
+#include "dft.hpp"
+#include "half.hpp"
+#include "fixed.hpp"
+#include "goertzel.hpp"
+
+template <typename T>
+void BM_fft(benchmark::State& state)
+{
+    auto input = random_complex<T>(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(fft::fft(input));
+    report_transform<T>(state, input.size());
+}
+
+template <typename T>
+void BM_inv_fft(benchmark::State& state)
+{
+    auto input = random_complex<T>(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(fft::inv_fft(input));
+    report_transform<T>(state, input.size());
+}
+
+template <typename T>
+void BM_fft_2d(benchmark::State& state)
+{
+    auto width = state.range(0);
+    auto input = random_complex<T>(width * state.range(1));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(fft::fft_2d(input, width));
+    report_transform<T>(state, input.size());
+}
+
+template <typename T>
+void BM_dft(benchmark::State& state)
+{
+    auto input = random_complex<T>(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(dft::dft(input));
+    report_transform<T>(state, input.size());
+}
+
+//batches of 1024 point transforms stored in 16 bits against float storage
+template <typename Storage>
+void BM_fft_batch(benchmark::State& state)
+{
+    auto length = 1024u;
+    auto values = random_complex<float>(state.range(0));
+    half::ComplexVec<Storage> input(values.size());
+    for (auto i = 0u; i < values.size(); ++i)
+        input[i] = half::complex<Storage>(values[i]);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(half::fft_batch(input, length, 1));
+    report_transform<float, half::complex<Storage>>(state, input.size());
+}
+
+template <typename T>
+void BM_fixed_fft(benchmark::State& state)
+{
+    auto values = random_complex<double>(state.range(0));
+    fixed::ComplexVec<T> input(values.size());
+    for (auto i = 0u; i < values.size(); ++i)
+    {
+        auto scale = double(std::numeric_limits<T>::max());
+        input[i] = fixed::complex<T>(T(values[i].real() * scale), T(values[i].imag() * scale));
+    }
+    for (auto _ : state)
+        benchmark::DoNotOptimize(fixed::fft(input));
+    report_transform<T, fixed::complex<T>>(state, input.size());
+}
+
+//the heuristic of goertzel::cheaper compares these two
+template <typename T>
+void BM_real_fft(benchmark::State& state)
+{
+    auto input = random_real<T>(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(fft::real_fft(input));
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename T>
+void BM_goertzel(benchmark::State& state)
+{
+    auto input = random_real<T>(state.range(0));
+    std::vector<double> bins;
+    for (auto i = 0; i < state.range(1); ++i)
+        bins.push_back(i * 7.5);
+    goertzel::plan<T> evaluator(input.size(), bins);
+    fft::ComplexVec<T> output(bins.size());
+    for (auto _ : state)
+    {
+        evaluator.execute(input.data(), output.data());
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+//the fft accepts only power of two sizes, the dft takes any
+#define FFT_SIZES RangeMultiplier(4)->Range(16, 1 << 20)
+#define FFT_2D_SIZES Args({64, 64})->Args({256, 256})->Args({1024, 1024})->Args({2048, 64})
+#define DFT_SIZES Arg(64)->Arg(100)->Arg(256)->Arg(500)
+
+BENCHMARK_TEMPLATE(BM_fft, float)->FFT_SIZES;
+BENCHMARK_TEMPLATE(BM_fft, double)->FFT_SIZES;
+BENCHMARK_TEMPLATE(BM_inv_fft, float)->FFT_SIZES;
+BENCHMARK_TEMPLATE(BM_inv_fft, double)->FFT_SIZES;
+BENCHMARK_TEMPLATE(BM_fft_2d, float)->FFT_2D_SIZES;
+BENCHMARK_TEMPLATE(BM_fft_2d, double)->FFT_2D_SIZES;
+BENCHMARK_TEMPLATE(BM_dft, float)->DFT_SIZES;
+BENCHMARK_TEMPLATE(BM_dft, double)->DFT_SIZES;
+BENCHMARK_TEMPLATE(BM_fft_batch, float)->Arg(1 << 22);
+BENCHMARK_TEMPLATE(BM_fft_batch, half::float16)->Arg(1 << 22);
+BENCHMARK_TEMPLATE(BM_fft_batch, half::bfloat16)->Arg(1 << 22);
+BENCHMARK_TEMPLATE(BM_fixed_fft, int16_t)->FFT_SIZES;
+BENCHMARK_TEMPLATE(BM_fixed_fft, int32_t)->FFT_SIZES;
+BENCHMARK_TEMPLATE(BM_real_fft, float)->Arg(4096)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_real_fft, double)->Arg(4096)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_goertzel, float)->ArgsProduct({{4096, 1 << 16}, {5, 20, 40}});
+BENCHMARK_TEMPLATE(BM_goertzel, double)->ArgsProduct({{4096, 1 << 16}, {5, 20, 40}});
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include "ntt.hpp"
+
+namespace bigint
+{
+
+//every limb holds limb_digits decimal digits, least significant limb first
+const uint32_t limb_base = 10000;
+const size_t limb_digits = 4;
+
+//operand sizes (in limbs) above which the faster multiplication methods take over
+const size_t karatsuba_threshold = 32;
+const size_t ntt_threshold = 1024;
+
+namespace detail
+{
+
+using coefficients = std::vector<int64_t>;
+
+inline coefficients schoolbook(const coefficients& first, const coefficients& second)
+{
+    coefficients ret(first.size() + second.size() - 1, 0);
+    for (auto i = 0u; i < first.size(); ++i)
+        for (auto j = 0u; j < second.size(); ++j)
+            ret[i + j] += first[i] * second[j];
+    return ret;
+}
+
+inline coefficients slice(const coefficients& arg, size_t begin, size_t end)
+{
+    begin = std::min(begin, arg.size());
+    end = std::min(end, arg.size());
+    return coefficients(arg.begin() + begin, arg.begin() + end);
+}
+
+inline void add_shifted(coefficients& target, const coefficients& arg, size_t shift, int64_t sign = 1)
+{
+    for (auto i = 0u; i < arg.size(); ++i)
+        target[i + shift] += sign * arg[i];
+}
+
+inline coefficients sum(coefficients first, const coefficients& second)
+{
+    if (first.size() < second.size()) first.resize(second.size(), 0);
+    add_shifted(first, second, 0);
+    return first;
+}
+
+//Polynomial product without carries; the coefficients stay small enough below
+//ntt_threshold for the recursion to never overflow 64 bits.
+inline coefficients karatsuba(const coefficients& first, const coefficients& second)
+{
+    if (std::min(first.size(), second.size()) < karatsuba_threshold)
+        return schoolbook(first, second);
+
+    auto half = (std::max(first.size(), second.size()) + 1) / 2;
+    coefficients ret(first.size() + second.size() - 1, 0);
+    if ((first.size() <= half) or (second.size() <= half))
+    {
+        auto& shorter = (first.size() <= half) ? first : second;
+        auto& longer = (first.size() <= half) ? second : first;
+        add_shifted(ret, karatsuba(shorter, slice(longer, 0, half)), 0);
+        add_shifted(ret, karatsuba(shorter, slice(longer, half, longer.size())), half);
+        return ret;
+    }
+
+    auto first_low = slice(first, 0, half), first_high = slice(first, half, first.size());
+    auto second_low = slice(second, 0, half), second_high = slice(second, half, second.size());
+    auto low = karatsuba(first_low, second_low);
+    auto high = karatsuba(first_high, second_high);
+    auto middle = karatsuba(sum(first_low, first_high), sum(second_low, second_high));
+    add_shifted(middle, low, 0, -1);
+    add_shifted(middle, high, 0, -1);
+
+    //the top coefficients of middle are zero but may reach past the product's size
+    ret.resize(std::max(ret.size(), half + middle.size()), 0);
+    add_shifted(ret, low, 0);
+    add_shifted(ret, middle, half);
+    add_shifted(ret, high, 2 * half);
+    ret.resize(first.size() + second.size() - 1);
+    return ret;
+}
+
+inline coefficients product(const coefficients& first, const coefficients& second)
+{
+    if (std::min(first.size(), second.size()) < karatsuba_threshold)
+        return schoolbook(first, second);
+    if (std::min(first.size(), second.size()) < ntt_threshold)
+        return karatsuba(first, second);
+    return ntt::convolve_exact(first, second);
+}
+
+inline std::vector<uint32_t> propagate_carries(const coefficients& product)
+{
+    std::vector<uint32_t> ret;
+    ret.reserve(product.size() + 1);
+    uint64_t carry = 0;
+    for (auto value : product)
+    {
+        carry += uint64_t(value);
+        ret.push_back(uint32_t(carry % limb_base));
+        carry /= limb_base;
+    }
+    for (; carry > 0; carry /= limb_base)
+        ret.push_back(uint32_t(carry % limb_base));
+    while (not ret.empty() and (ret.back() == 0))
+        ret.pop_back();
+    return ret;
+}
+
+} //namespace detail
+
+//Product of two numbers given as limbs: schoolbook for short operands, Karatsuba
+//for medium ones and exact NTT convolution above ntt_threshold limbs.
+inline std::vector<uint32_t> multiply(const std::vector<uint32_t>& first,
+                                      const std::vector<uint32_t>& second)
+{
+    if (first.empty() or second.empty()) return {};
+    return detail::propagate_carries(detail::product(
+        detail::coefficients(first.begin(), first.end()),
+        detail::coefficients(second.begin(), second.end())));
+}
+
+//Non-negative integer of arbitrary size supporting decimal conversion and multiplication.
+class natural
+{
+public:
+    natural() {}
+
+    explicit natural(uint64_t value)
+    {
+        for (; value > 0; value /= limb_base)
+            limbs_.push_back(uint32_t(value % limb_base));
+    }
+
+    explicit natural(const std::string& decimal)
+    {
+        if (decimal.empty())
+            throw std::invalid_argument("empty number");
+        if (decimal.find_first_not_of("0123456789") != std::string::npos)
+            throw std::invalid_argument("not a decimal number: " + decimal);
+
+        for (auto end = decimal.size(); end > 0; end -= std::min(end, limb_digits))
+        {
+            auto begin = end - std::min(end, limb_digits);
+            limbs_.push_back(uint32_t(std::stoul(decimal.substr(begin, end - begin))));
+        }
+        while (not limbs_.empty() and (limbs_.back() == 0))
+            limbs_.pop_back();
+    }
+
+    const std::vector<uint32_t>& limbs() const
+    {
+        return limbs_;
+    }
+
+    std::string to_string() const
+    {
+        if (limbs_.empty()) return "0";
+        auto ret = std::to_string(limbs_.back());
+        for (auto it = limbs_.rbegin() + 1; it != limbs_.rend(); ++it)
+        {
+            auto digits = std::to_string(*it);
+            ret += std::string(limb_digits - digits.size(), '0') + digits;
+        }
+        return ret;
+    }
+
+    friend natural operator*(const natural& first, const natural& second)
+    {
+        natural ret;
+        ret.limbs_ = multiply(first.limbs_, second.limbs_);
+        return ret;
+    }
+
+    friend bool operator==(const natural& first, const natural& second)
+    {
+        return first.limbs_ == second.limbs_;
+    }
+
+    friend bool operator!=(const natural& first, const natural& second)
+    {
+        return not (first == second);
+    }
+
+private:
+    std::vector<uint32_t> limbs_;
+};
+
+} //namespace bigint
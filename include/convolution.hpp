@@ -1,17 +1,28 @@
 #pragma once
 
 #include <vector>
+#include <memory>
+#include <list>
 #include <algorithm>
+#include <stdexcept>
 #include "fft.hpp"
 #include "dft.hpp"
+#include "parallel.hpp"
 
 namespace convolution
 {
 
+enum class mode
+{
+    full,
+    same,
+    valid
+};
+
 namespace detail
 {
 
-size_t nearest_power_of_2(size_t size)
+inline size_t nearest_power_of_2(size_t size)
 {
     auto aux_size = size;
     for (auto i = 0u; i < sizeof(aux_size) * 8 - 1; ++i)
@@ -46,6 +57,128 @@ std::vector<T> resize_matrix(
             ret[row * width + col] = arg[row * original_width + col];
     return ret;
 }
+
+//part of a linear convolution kept by the given mode along one dimension
+struct output_range
+{
+    size_t first;
+    size_t count;
+};
+
+inline output_range kept_outputs(mode output_mode, size_t input_size, size_t kernel_size)
+{
+    if (output_mode == mode::full)
+        return {0, input_size + kernel_size - 1};
+    if (output_mode == mode::same)
+        return {(kernel_size - 1) / 2, input_size};
+    if (kernel_size > input_size)
+        throw std::runtime_error("kernel dimension is bigger than input's");
+    return {kernel_size - 1, input_size - kernel_size + 1};
+}
+
+//rows of the matrix stride apart, up to the end of the last row; the zeros after
+//it are left to the input pruned transform
+template <typename T>
+fft::ComplexVec<T> embed(const std::vector<T>& matrix, size_t width, size_t stride)
+{
+    auto height = matrix.size() / width;
+    auto size = (height == 0) ? 0 : (height - 1) * stride + width;
+    FFT_INSTRUMENT_ALLOCATION(size * sizeof(std::complex<T>));
+    fft::ComplexVec<T> ret(size);
+    for (auto row = 0u; row < height; ++row)
+        for (auto col = 0u; col < width; ++col)
+            ret[row * stride + col] = matrix[row * width + col];
+    return ret;
+}
+
+//row stride, transform size and position of the kept outputs of a 2D convolution
+struct layout
+{
+    output_range rows;
+    output_range cols;
+    size_t stride;
+    size_t lowest;
+    size_t size;
+};
+
+inline layout make_layout(mode output_mode,
+                          size_t first_width, size_t first_height,
+                          size_t second_width, size_t second_height)
+{
+    auto rows = kept_outputs(output_mode, first_height, second_height);
+    auto cols = kept_outputs(output_mode, first_width, second_width);
+
+    auto stride = std::max(first_width + second_width - 1 - cols.first, cols.first + cols.count);
+    auto lowest = rows.first * stride + cols.first;
+    auto highest = (rows.first + rows.count - 1) * stride + cols.first + cols.count - 1;
+    auto last = (first_height + second_height - 2) * stride + first_width + second_width - 2;
+    auto size = nearest_power_of_2(std::max(highest + 1, last - lowest + 1));
+    return {rows, cols, stride, lowest, size};
+}
+
+template <typename T>
+std::vector<T> extract(const fft::ComplexVec<T>& inverted, const layout& shape)
+{
+    std::vector<T> ret(shape.rows.count * shape.cols.count);
+    for (auto row = 0u; row < shape.rows.count; ++row)
+        for (auto col = 0u; col < shape.cols.count; ++col)
+            ret[row * shape.cols.count + col] =
+                inverted[shape.lowest + row * shape.stride + col].real();
+    return ret;
+}
+
+//Linear convolution of two matrices is computed as a circular convolution of their
+//flattened forms. The row stride and the transform size are the smallest for which
+//the wrapped around terms land only on outputs the mode discards.
+template <typename T>
+std::vector<T> linear_convolve_2d(const std::vector<T>& first, size_t first_width,
+                                  const std::vector<T>& second, size_t second_width,
+                                  mode output_mode)
+{
+    auto shape = make_layout(output_mode,
+                             first_width, first.size() / first_width,
+                             second_width, second.size() / second_width);
+
+    auto freq_first = fft::fft_input_pruned(embed(first, first_width, shape.stride), shape.size);
+    auto freq_second = fft::fft_input_pruned(embed(second, second_width, shape.stride), shape.size);
+    {
+        FFT_INSTRUMENT_STAGE(spectral_product);
+        for (auto i = 0u; i < shape.size; ++i)
+            freq_first[i] *= freq_second[i];
+    }
+    return extract(fft::inv_fft(freq_first), shape);
+}
+
+//spectra of a block of filters this big stay in cache while every channel is multiplied by them
+const size_t batch_block_bytes = 256u << 10;
+
+//spectrum of the reversed kernel zero padded to the given size: for a real kernel
+//the conjugate of the spectrum of the kernel itself, an input pruned transform
+template <typename T>
+fft::ComplexVec<T> kernel_spectrum(const std::vector<T>& kernel, size_t size)
+{
+    auto ret = fft::fft_input_pruned(dft::real2complex(kernel), size);
+    for (auto& value : ret)
+        value = std::conj(value);
+    return ret;
+}
+
+template <typename T>
+std::vector<T> apply_spectrum(const std::vector<T>& input,
+                              const fft::ComplexVec<T>& kernel_spectrum,
+                              size_t output_size)
+{
+    auto freq_input = fft::fft_input_pruned(dft::real2complex(input), kernel_spectrum.size());
+    {
+        FFT_INSTRUMENT_STAGE(spectral_product);
+        for (auto i = 0u; i < freq_input.size(); ++i)
+            freq_input[i] *= kernel_spectrum[i];
+    }
+
+    auto inverted = fft::inv_fft(freq_input);
+    inverted.resize(output_size);
+    return dft::real(inverted);
+}
 } //namespace detail
 
 template <typename T, bool T_resize = true>
@@ -53,29 +186,144 @@ std::vector<T> convolve(std::vector<T> first,
                         std::vector<T> second)
 {
     auto original_size = first.size();
-    if (T_resize)
+    auto size = original_size;
+    if (T_resize) size = detail::nearest_power_of_2(first.size() + second.size());
+
+    return detail::apply_spectrum(
+        first, detail::kernel_spectrum(second, size), original_size);
+}
+
+//Linear convolution with numpy-like modes: full gives every output, same the
+//first.size() outputs centered on the full result and valid only the outputs
+//to which the whole kernel contributes.
+template <typename T>
+std::vector<T> convolve(const std::vector<T>& first,
+                        const std::vector<T>& second,
+                        mode output_mode)
+{
+    return detail::linear_convolve_2d(first, first.size(), second, second.size(), output_mode);
+}
+
+//Convolves every channel with every filter (as convolve with the given mode), with
+//ret[channel][filter] holding the result. Each channel and each filter is transformed
+//once; the spectral products and inverse transforms are spread across the threads.
+template <typename T>
+std::vector<std::vector<std::vector<T>>> convolve_batch(
+    const std::vector<std::vector<T>>& channels,
+    const std::vector<std::vector<T>>& filters,
+    mode output_mode,
+    size_t threads = parallel::default_threads())
+{
+    std::vector<std::vector<std::vector<T>>> ret(
+        channels.size(), std::vector<std::vector<T>>(filters.size()));
+    if (channels.empty() or filters.empty()) return ret;
+
+    auto input_size = channels.front().size();
+    auto kernel_size = filters.front().size();
+    for (auto& channel : channels)
+        if (channel.size() != input_size)
+            throw std::runtime_error("all channels must have the same length");
+    for (auto& filter : filters)
+        if (filter.size() != kernel_size)
+            throw std::runtime_error("all filters must have the same length");
+
+    auto shape = detail::make_layout(output_mode, input_size, 1, kernel_size, 1);
+    //plans are read only once built; the workers are new threads with empty plan caches
+    std::shared_ptr<const fft::plan<T>> held;
+    auto& transform = fft::impl::plan_for<T>(shape.size, held);
+
+    std::vector<fft::ComplexVec<T>> spectra(channels.size() + filters.size());
+    parallel::for_each(spectra.size(), threads, [&](size_t i) {
+        auto& source = (i < channels.size()) ? channels[i] : filters[i - channels.size()];
+        auto embedded = detail::embed(source, source.size(), shape.stride);
+        spectra[i].resize(shape.size);
+        transform.execute_pruned(embedded.data(), embedded.size(), spectra[i].data(), false);
+    });
+
+    auto block = std::max<size_t>(
+        1, detail::batch_block_bytes / (shape.size * sizeof(std::complex<T>)));
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (auto first_filter = 0u; first_filter < filters.size(); first_filter += block)
+        for (auto channel = 0u; channel < channels.size(); ++channel)
+            for (auto filter = first_filter;
+                 filter < std::min(first_filter + block, filters.size()); ++filter)
+                pairs.emplace_back(channel, filter);
+
+    parallel::for_ranges(pairs.size(), threads, [&](size_t begin, size_t end) {
+        fft::ComplexVec<T> product(shape.size);
+        for (auto i = begin; i < end; ++i)
+        {
+            auto& channel = spectra[pairs[i].first];
+            auto& filter = spectra[channels.size() + pairs[i].second];
+            {
+                FFT_INSTRUMENT_STAGE(spectral_product);
+                for (auto k = 0u; k < shape.size; ++k)
+                    product[k] = channel[k] * filter[k];
+            }
+            transform.execute(product.data(), true);
+            ret[pairs[i].first][pairs[i].second] = detail::extract(product, shape);
+        }
+    });
+    return ret;
+}
+
+//Convolves many inputs with the same kernel (with the semantics of convolve),
+//keeping the kernel spectrum for every transform size it was needed for.
+//The least recently used spectra are dropped once they take more than max_cache_bytes.
+//Not thread safe, since applying the filter updates the cache.
+template <typename T>
+class filter
+{
+public:
+    explicit filter(std::vector<T> kernel, size_t max_cache_bytes = 64u << 20)
+        : kernel_(std::move(kernel)), max_cache_bytes_(max_cache_bytes)
+    {}
+
+    std::vector<T> operator()(std::vector<T> input)
     {
-        auto calc_size = detail::nearest_power_of_2(first.size() + second.size());
-        first.resize(calc_size, T());
-        second.resize(first.size(), T());
+        auto original_size = input.size();
+        auto size = detail::nearest_power_of_2(input.size() + kernel_.size());
+        return detail::apply_spectrum(input, spectrum(size), original_size);
     }
-    std::reverse(second.begin(), second.end());
-    std::rotate(second.begin(), second.end() - 1, second.end());
 
-    auto freq_first = fft::fft(dft::real2complex(first));
-    auto freq_second = fft::fft(dft::real2complex(second));
+    size_t cached_spectra() const
+    {
+        return cache_.size();
+    }
 
-    for (auto i = 0u; i < first.size(); ++i)
-        freq_first[i] *= freq_second[i];
-    
-    auto inverted = fft::inv_fft(freq_first);
-    if (T_resize)
+    size_t cached_bytes() const
     {
-        inverted.resize(original_size);
+        size_t ret = 0;
+        for (auto& entry : cache_)
+            ret += entry.second.size() * sizeof(std::complex<T>);
+        return ret;
     }
 
-    return dft::real(inverted);
-}
+private:
+    using cache_entry = std::pair<size_t, fft::ComplexVec<T>>;
+
+    const fft::ComplexVec<T>& spectrum(size_t size)
+    {
+        auto found = std::find_if(cache_.begin(), cache_.end(),
+            [size](const cache_entry& entry) { return entry.first == size; });
+        if (found != cache_.end())
+        {
+            FFT_INSTRUMENT_COUNT(spectrum_cache_hits, 1);
+            cache_.splice(cache_.begin(), cache_, found);
+            return cache_.front().second;
+        }
+
+        FFT_INSTRUMENT_COUNT(spectrum_cache_misses, 1);
+        cache_.emplace_front(size, detail::kernel_spectrum(kernel_, size));
+        while ((cache_.size() > 1) and (cached_bytes() > max_cache_bytes_))
+            cache_.pop_back();
+        return cache_.front().second;
+    }
+
+    std::vector<T> kernel_;
+    size_t max_cache_bytes_;
+    std::list<cache_entry> cache_;
+};
 
 template <typename T>
 std::vector<T> convolve_2d(
@@ -98,5 +346,13 @@ std::vector<T> convolve_2d(
         width, height, first_height, first_width);
 }
 
-} //namespace convolution
+template <typename T>
+std::vector<T> convolve_2d(
+    const std::vector<T>& first, size_t first_width,
+    const std::vector<T>& second, size_t second_width,
+    mode output_mode)
+{
+    return detail::linear_convolve_2d(first, first_width, second, second_width, output_mode);
+}
 
+} //namespace convolution
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include "fft.hpp"
+#include "convolution.hpp"
+
+namespace correlation
+{
+
+using convolution::mode;
+
+namespace detail
+{
+
+struct lag_range
+{
+    long first;
+    size_t count;
+};
+
+//lags (signal index minus template index) kept by the given mode along one dimension
+inline lag_range lags(mode output_mode, size_t signal_size, size_t template_size)
+{
+    auto template_lags = long(template_size) - 1;
+    if (output_mode == mode::full)
+        return {-template_lags, signal_size + template_size - 1};
+    if (output_mode == mode::same)
+        return {template_lags / 2 - template_lags, signal_size};
+    if (template_size > signal_size)
+        throw std::runtime_error("template dimension is bigger than signal's");
+    return {0, signal_size - template_size + 1};
+}
+
+template <typename T>
+struct circular_view
+{
+    const fft::ComplexVec<T>& data;
+    size_t stride;
+
+    T operator()(long row, long col) const
+    {
+        auto size = long(data.size());
+        auto index = (row * long(stride) + col) % size;
+        return data[(index + size) % size].real();
+    }
+};
+
+template <typename T, typename Lookup>
+std::vector<T> gather(lag_range rows, lag_range cols, Lookup lookup)
+{
+    std::vector<T> ret(rows.count * cols.count);
+    for (auto row = 0u; row < rows.count; ++row)
+        for (auto col = 0u; col < cols.count; ++col)
+            ret[row * cols.count + col] = lookup(rows.first + long(row), cols.first + long(col));
+    return ret;
+}
+
+template <typename T>
+std::vector<T> integral_image(const std::vector<T>& matrix, size_t width, bool squared)
+{
+    auto height = matrix.size() / width;
+    std::vector<T> ret((height + 1) * (width + 1), T());
+    for (auto row = 0u; row < height; ++row)
+    {
+        T row_sum = T();
+        for (auto col = 0u; col < width; ++col)
+        {
+            auto value = matrix[row * width + col];
+            row_sum += squared ? value * value : value;
+            ret[(row + 1) * (width + 1) + col + 1] = ret[row * (width + 1) + col + 1] + row_sum;
+        }
+    }
+    return ret;
+}
+
+//sum of the matrix over the window at the given lag, treating everything outside as zero
+template <typename T>
+T window_sum(const std::vector<T>& integral, size_t width, size_t height,
+             long row, long col, size_t window_width, size_t window_height)
+{
+    auto clamp = [](long value, size_t limit) {
+        return size_t(std::min(std::max(value, 0l), long(limit)));
+    };
+    auto top = clamp(row, height);
+    auto bottom = clamp(row + long(window_height), height);
+    auto left = clamp(col, width);
+    auto right = clamp(col + long(window_width), width);
+    auto stride = width + 1;
+    return integral[bottom * stride + right] - integral[top * stride + right]
+         - integral[bottom * stride + left] + integral[top * stride + left];
+}
+
+} //namespace detail
+
+//Keeps the spectrum of a signal so it can be correlated against many templates
+//at the cost of a single forward and inverse transform per template.
+template <typename T>
+class correlator
+{
+public:
+    correlator(const std::vector<T>& signal, size_t max_template_size)
+        : correlator(signal, signal.size(), max_template_size, 1)
+    {}
+
+    correlator(const std::vector<T>& signal, size_t width,
+               size_t max_template_width, size_t max_template_height)
+        : width_(checked_width(signal, width)),
+          height_(signal.size() / width),
+          max_template_width_(max_template_width),
+          max_template_height_(max_template_height),
+          stride_(width + max_template_width - 1),
+          size_(convolution::detail::nearest_power_of_2(
+              (height_ + max_template_height - 1) * stride_)),
+          spectrum_(fft::fft_input_pruned(convolution::detail::embed(signal, width, stride_), size_)),
+          sums_(detail::integral_image(signal, width, false)),
+          squares_(detail::integral_image(signal, width, true))
+    {}
+
+    std::vector<T> correlate(const std::vector<T>& pattern, mode output_mode = mode::full) const
+    {
+        return correlate(pattern, pattern.size(), output_mode);
+    }
+
+    std::vector<T> correlate(const std::vector<T>& pattern, size_t pattern_width,
+                             mode output_mode = mode::full) const
+    {
+        auto pattern_height = pattern.size() / pattern_width;
+        if ((pattern_width > max_template_width_) or (pattern_height > max_template_height_))
+            throw std::runtime_error("template is bigger than the correlator was prepared for");
+
+        auto product = fft::fft_input_pruned(convolution::detail::embed(pattern, pattern_width, stride_), size_);
+        {
+            FFT_INSTRUMENT_STAGE(spectral_product);
+            for (auto i = 0u; i < size_; ++i)
+                product[i] = spectrum_[i] * std::conj(product[i]);
+        }
+        auto circular = fft::inv_fft(product);
+
+        return detail::gather<T>(
+            detail::lags(output_mode, height_, pattern_height),
+            detail::lags(output_mode, width_, pattern_width),
+            detail::circular_view<T>{circular, stride_});
+    }
+
+    std::vector<T> normalized(const std::vector<T>& pattern, mode output_mode = mode::full) const
+    {
+        return normalized(pattern, pattern.size(), output_mode);
+    }
+
+    //Pearson correlation coefficient between the template and every signal window;
+    //windows (or templates) without variance give 0.
+    std::vector<T> normalized(const std::vector<T>& pattern, size_t pattern_width,
+                              mode output_mode = mode::full) const
+    {
+        auto pattern_height = pattern.size() / pattern_width;
+        auto count = T(pattern.size());
+
+        T mean = T();
+        for (auto value : pattern) mean += value;
+        mean /= count;
+
+        auto centered = pattern;
+        T energy = T();
+        for (auto& value : centered)
+        {
+            value -= mean;
+            energy += value * value;
+        }
+
+        auto ret = correlate(centered, pattern_width, output_mode);
+        auto rows = detail::lags(output_mode, height_, pattern_height);
+        auto cols = detail::lags(output_mode, width_, pattern_width);
+        auto tolerance = std::numeric_limits<T>::epsilon() * count;
+        for (auto row = 0u; row < rows.count; ++row)
+        {
+            for (auto col = 0u; col < cols.count; ++col)
+            {
+                auto lag_row = rows.first + long(row);
+                auto lag_col = cols.first + long(col);
+                auto sum = detail::window_sum(
+                    sums_, width_, height_, lag_row, lag_col, pattern_width, pattern_height);
+                auto squares = detail::window_sum(
+                    squares_, width_, height_, lag_row, lag_col, pattern_width, pattern_height);
+                auto variance = squares - sum * sum / count;
+
+                auto& elem = ret[row * cols.count + col];
+                if ((variance <= tolerance * squares) or (energy <= T()))
+                    elem = T();
+                else
+                    elem = std::max(T(-1), std::min(T(1), elem / std::sqrt(variance * energy)));
+            }
+        }
+        return ret;
+    }
+
+private:
+    static size_t checked_width(const std::vector<T>& signal, size_t width)
+    {
+        if (signal.empty() or (width == 0))
+            throw std::runtime_error("correlator needs a nonempty signal and width");
+        return width;
+    }
+
+    size_t width_;
+    size_t height_;
+    size_t max_template_width_;
+    size_t max_template_height_;
+    size_t stride_;
+    size_t size_;
+    fft::ComplexVec<T> spectrum_;
+    std::vector<T> sums_;
+    std::vector<T> squares_;
+};
+
+//correlation is a convolution with the reversed template, which sizes the transform
+//for the requested mode; use correlator to reuse the signal's spectrum instead
+template <typename T>
+std::vector<T> correlate(const std::vector<T>& signal,
+                         std::vector<T> pattern,
+                         mode output_mode = mode::full)
+{
+    std::reverse(pattern.begin(), pattern.end());
+    return convolution::convolve(signal, pattern, output_mode);
+}
+
+template <typename T>
+std::vector<T> correlate_2d(const std::vector<T>& signal, size_t width,
+                            std::vector<T> pattern, size_t pattern_width,
+                            mode output_mode = mode::full)
+{
+    std::reverse(pattern.begin(), pattern.end());
+    return convolution::convolve_2d(signal, width, pattern, pattern_width, output_mode);
+}
+
+template <typename T>
+std::vector<T> normalized_correlate(const std::vector<T>& signal,
+                                    const std::vector<T>& pattern,
+                                    mode output_mode = mode::full)
+{
+    return correlator<T>(signal, pattern.size()).normalized(pattern, output_mode);
+}
+
+template <typename T>
+std::vector<T> normalized_correlate_2d(const std::vector<T>& signal, size_t width,
+                                       const std::vector<T>& pattern, size_t pattern_width,
+                                       mode output_mode = mode::full)
+{
+    return correlator<T>(signal, width, pattern_width, pattern.size() / pattern_width)
+        .normalized(pattern, pattern_width, output_mode);
+}
+
+//needs a single forward transform, since the spectrum is correlated with itself
+template <typename T>
+std::vector<T> autocorrelate_2d(const std::vector<T>& signal, size_t width,
+                                mode output_mode = mode::full)
+{
+    auto height = signal.size() / width;
+    auto stride = 2 * width - 1;
+    auto size = convolution::detail::nearest_power_of_2((2 * height - 1) * stride);
+
+    auto spectrum = fft::fft_input_pruned(convolution::detail::embed(signal, width, stride), size);
+    for (auto& elem : spectrum)
+        elem = std::norm(elem);
+    auto circular = fft::inv_fft(spectrum);
+
+    return detail::gather<T>(
+        detail::lags(output_mode, height, height),
+        detail::lags(output_mode, width, width),
+        detail::circular_view<T>{circular, stride});
+}
+
+template <typename T>
+std::vector<T> autocorrelate(const std::vector<T>& signal, mode output_mode = mode::full)
+{
+    return autocorrelate_2d(signal, signal.size(), output_mode);
+}
+
+} //namespace correlation
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <complex>
+#include <stdexcept>
+#include "fft.hpp"
+#include "memory.hpp"
+
+//Chirp-z transform X[k] = sum of x[n] A^-n W^nk for k < M, the values of the
+//z-transform at the points A W^-k of a spiral (an arc of the unit circle when
+//|A| = |W| = 1). With nk = (n^2 + k^2 - (k - n)^2) / 2 it becomes a convolution
+//with the chirp W^(-m^2 / 2), done with transforms of a power of two size
+//L >= N + M - 1: the input is zero padded (input pruned transform) and only the
+//first M outputs of the inverse are needed (output pruned transform).
+
+namespace czt
+{
+
+namespace detail
+{
+
+const long double pi = 3.141592653589793238462643383279502884L;
+
+//magnitude and angle kept in long double, so that the powers of large exponents
+//come from one multiplication of the angle instead of repeated products
+struct spiral
+{
+    long double magnitude;
+    long double angle;
+
+    template <typename T>
+    std::complex<T> power(long double exponent) const
+    {
+        auto scale = std::pow(magnitude, exponent);
+        auto phase = angle * exponent;
+        return std::complex<T>(T(scale * std::cos(phase)), T(scale * std::sin(phase)));
+    }
+};
+
+inline spiral polar(std::complex<double> value)
+{
+    if (value == std::complex<double>())
+        throw std::runtime_error("chirp-z spiral parameters have to be nonzero");
+    return {std::abs((std::complex<long double>)value), std::arg((std::complex<long double>)value)};
+}
+
+} //namespace detail
+
+template <typename T>
+class plan
+{
+public:
+    //M = output_size points A W^-k; by default the first M bins of the dft
+    plan(size_t input_size, size_t output_size, std::complex<double> w, std::complex<double> a = 1.0)
+        : plan(input_size, output_size, detail::polar(w), detail::polar(a))
+    {}
+
+    //output_size points spaced evenly over [first, last] in cycles per sample
+    //(fractions of the sample rate), last included
+    static plan zoom(size_t input_size, size_t output_size, double first, double last)
+    {
+        auto step = (output_size > 1) ? ((long double)(last) - first) / (output_size - 1) : 0.0L;
+        return plan(input_size, output_size, detail::spiral{1.0L, -2 * detail::pi * step},
+                    detail::spiral{1.0L, 2 * detail::pi * (long double)(first)});
+    }
+
+    size_t input_size() const
+    {
+        return pre_.size();
+    }
+
+    size_t output_size() const
+    {
+        return post_.size();
+    }
+
+    //size of the transforms of the convolution
+    size_t fft_size() const
+    {
+        return chirp_.size();
+    }
+
+    void execute(const std::complex<T>* input, std::complex<T>* output) const
+    {
+        auto size = fft_size();
+        memory::workspace<std::complex<T>> weighted(input_size());
+        memory::workspace<std::complex<T>> work(size);
+        for (auto n = size_t(0); n < input_size(); ++n)
+            weighted[n] = input[n] * pre_[n];
+
+        std::shared_ptr<const fft::plan<T>> held;
+        auto& transform = fft::impl::plan_for<T>(size, held);
+        transform.execute_pruned(weighted.data(), input_size(), work.data(), false);
+        for (auto k = size_t(0); k < size; ++k)
+            work[k] *= chirp_[k];
+        transform.execute_band(work.data(), 0, output_size(), true);
+        for (auto k = size_t(0); k < output_size(); ++k)
+            output[k] = work[k] * post_[k];
+    }
+
+    fft::ComplexVec<T> execute(const fft::ComplexVec<T>& input) const
+    {
+        if (input.size() != input_size())
+            throw std::runtime_error("chirp-z input size differs from the plan");
+        fft::ComplexVec<T> ret(output_size());
+        execute(input.data(), ret.data());
+        return ret;
+    }
+
+private:
+    plan(size_t input_size, size_t output_size, detail::spiral w, detail::spiral a)
+    {
+        if ((input_size == 0) or (output_size == 0))
+            throw std::runtime_error("chirp-z sizes have to be positive");
+        auto size = size_t(1);
+        while (size < input_size + output_size - 1) size *= 2;
+
+        //A^-n W^(n^2 / 2), W^(k^2 / 2) and the spectrum of W^(-m^2 / 2) for -N < m < M
+        auto inverse_a = detail::spiral{1.0L / a.magnitude, -a.angle};
+        for (auto n = size_t(0); n < input_size; ++n)
+        {
+            auto half_square = (long double)(n) * (long double)(n) / 2;
+            pre_.push_back(inverse_a.power<T>((long double)(n)) * w.power<T>(half_square));
+        }
+        for (auto k = size_t(0); k < output_size; ++k)
+            post_.push_back(w.power<T>((long double)(k) * (long double)(k) / 2));
+
+        fft::ComplexVec<T> chirp(size);
+        auto inverse_w = detail::spiral{1.0L / w.magnitude, -w.angle};
+        for (auto m = size_t(0); m < output_size; ++m)
+            chirp[m] = inverse_w.power<T>((long double)(m) * (long double)(m) / 2);
+        for (auto m = size_t(1); m < input_size; ++m)
+            chirp[size - m] = inverse_w.power<T>((long double)(m) * (long double)(m) / 2);
+        chirp_ = fft::fft(chirp);
+    }
+
+    fft::ComplexVec<T> pre_;
+    fft::ComplexVec<T> post_;
+    fft::ComplexVec<T> chirp_;
+};
+
+//output_size values of the spectrum of input between the frequencies first and
+//last (in cycles per sample), both included
+template <typename T>
+fft::ComplexVec<T> zoom_fft(const fft::ComplexVec<T>& input, size_t output_size, double first, double last)
+{
+    return plan<T>::zoom(input.size(), output_size, first, last).execute(input);
+}
+
+} //namespace czt
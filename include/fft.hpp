@@ -1,8 +1,16 @@
 #pragma once
 
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include <complex>
 #include <vector>
+#include <stdexcept>
+#include <utility>
 #include "matrix.hpp"
+#include "memory.hpp"
+#include "instrumentation.hpp"
 
 namespace fft
 {
@@ -13,63 +21,480 @@ using ComplexVec=std::vector<std::complex<T>>;
 namespace impl
 {
 
-template <bool is_inverse, bool is_first, typename T>
-auto fft_impl(ComplexVec<T> input) -> decltype(input)
+inline bool is_power_of_2(size_t size)
 {
-    static T pi = T(3.141592653589793238463);
-    static T pi2 = pi * 2.0;
-    static std::complex<T> ci(0, 1);
-    static std::complex<T> mult = (is_inverse) ? ci : -ci;
-    if (input.size() == 1) return input;
-    assert(input.size() % 2 == 0);
+    return (size != 0) and ((size & (size - 1)) == 0);
+}
+
+//position every element goes to when the bits of its index are reversed; as big
+//as the data, so it is kept on huge pages like the twiddles
+inline memory::huge_vector<size_t> bit_reversal_table(size_t size)
+{
+    memory::huge_vector<size_t> ret(size, 0);
+    for (auto i = size_t(1); i < size; ++i)
+        ret[i] = (ret[i >> 1] >> 1) | ((i & 1) ? (size >> 1) : 0);
+    return ret;
+}
 
-    T N = input.size();
-    auto even = decltype(input)(input.size() / 2);
-    auto odd = decltype(input)(input.size() / 2);
+template <typename Element>
+void bit_reverse_permute(Element* data, const memory::huge_vector<size_t>& table)
+{
+    for (auto i = size_t(0); i < table.size(); ++i)
+        if (i < table[i]) std::swap(data[i], data[table[i]]);
+}
 
-    for (auto i = 0; i < even.size(); ++i)
+//Iterative radix-2 decimation in time over bit reversed data, shared by every
+//transform working over a field with power of two roots of unity. The butterfly
+//gets both elements and the index of the root in a table of size / 2 roots.
+template <typename Element, typename Butterfly>
+void radix2_passes(Element* data, size_t size, Butterfly butterfly)
+{
+    for (auto half = size_t(1); half < size; half *= 2)
     {
-        even[i] = input[2 * i];
-        odd[i] = input[2 * i + 1];
+        auto step = size / (2 * half);
+        for (auto block = 0u; block < size; block += 2 * half)
+            for (auto j = 0u; j < half; ++j)
+                butterfly(data[block + j], data[block + j + half], j * step);
     }
+}
 
-    auto even_result = fft_impl<is_inverse, false>(even);
-    auto odd_result = fft_impl<is_inverse, false>(odd);
-
-    ComplexVec<T> result(input.size());
-    for (auto i = 0; i < result.size(); ++i)
+//Butterflies over interleaved real and imaginary parts, written with real arithmetic
+//so that the compiler vectorizes the inner loop (std::complex multiplication has
+//to care for infinities and does not). The pass combining blocks of half elements
+//reads its twiddles from [half, 2 * half) of the tables; it runs only the
+//butterflies [begin, end) of every block, which pruned transforms narrow down.
+template <bool is_inverse, typename T>
+void butterfly_pass(T* values, size_t size, size_t half, const T* twiddles_re, const T* twiddles_im,
+                    size_t begin, size_t end)
+{
+    auto w_re = twiddles_re + half;
+    auto w_im = twiddles_im + half;
+    for (auto block = size_t(0); block < size; block += 2 * half)
     {
-        result[i] = odd_result[i % odd.size()] * exp(mult * T(i) * pi2 / N)
-            + even_result[i % even.size()];
-        if (is_inverse and is_first) result[i] /= N;
+        auto a = values + 2 * block;
+        auto b = a + 2 * half;
+        for (auto j = begin; j < end; ++j)
+        {
+            auto re = w_re[j];
+            auto im = is_inverse ? -w_im[j] : w_im[j];
+            auto t_re = b[2 * j] * re - b[2 * j + 1] * im;
+            auto t_im = b[2 * j] * im + b[2 * j + 1] * re;
+            auto a_re = a[2 * j], a_im = a[2 * j + 1];
+            b[2 * j] = a_re - t_re;
+            b[2 * j + 1] = a_im - t_im;
+            a[2 * j] = a_re + t_re;
+            a[2 * j + 1] = a_im + t_im;
+        }
     }
-    
-    return result;
 }
 
+//the passes with first_half <= half < end_half, the first without twiddles
 template <bool is_inverse, typename T>
-ComplexVec<T> fft_2d_impl(ComplexVec<T> input, size_t width) 
+void butterflies(T* values, size_t size, const T* twiddles_re, const T* twiddles_im,
+                 size_t first_half = 1, size_t end_half = 0)
 {
-    if (input.size() == 1) return input;
-    
-    auto height = input.size() / width;
+    if (end_half == 0) end_half = size;
+    if ((first_half == 1) and (end_half > 1))
+    {
+        for (auto block = size_t(0); block < 2 * size; block += 4)
+        {
+            auto a_re = values[block], a_im = values[block + 1];
+            auto b_re = values[block + 2], b_im = values[block + 3];
+            values[block] = a_re + b_re;
+            values[block + 1] = a_im + b_im;
+            values[block + 2] = a_re - b_re;
+            values[block + 3] = a_im - b_im;
+        }
+        first_half = 2;
+    }
+
+    for (auto half = first_half; half < end_half; half *= 2)
+        butterfly_pass<is_inverse>(values, size, half, twiddles_re, twiddles_im, 0, half);
+}
+
+} //namespace impl
+
+//Precomputed bit reversal permutation and twiddles for one power of two size.
+//The twiddles are evaluated in long double and rounded once to T, so that the
+//float transforms, which run entirely in float, start from exact roots of unity.
+template <typename T>
+class plan
+{
+public:
+    explicit plan(size_t size)
+        : size_(size),
+          permutation_(impl::bit_reversal_table(size)),
+          twiddles_re_(size),
+          twiddles_im_(size)
+    {
+        if (not impl::is_power_of_2(size))
+            throw std::runtime_error("fft size has to be a power of two");
+
+        FFT_INSTRUMENT_COUNT(plans_created, 1);
+        FFT_INSTRUMENT_COUNT(twiddle_tables_computed, 1);
 
-    auto perform_row_fft = [](ComplexVec<T> input, size_t width, size_t height){
-            ComplexVec<T> result;
-            for (auto row = 0u; row < height; ++row)
+        static const long double pi = 3.141592653589793238462643383279502884L;
+        for (auto half = size_t(1); half < size; half *= 2)
+        {
+            for (auto j = 0u; j < half; ++j)
             {
-                ComplexVec<T> row_data(input.begin() + row * width, input.begin() + (row + 1) * width);
-                auto row_result = fft_impl<is_inverse, true>(row_data);
-                result.insert(result.end(), row_result.begin(), row_result.end());
+                auto angle = -pi * (long double)(j) / (long double)(half);
+                twiddles_re_[half + j] = T(std::cos(angle));
+                twiddles_im_[half + j] = T(std::sin(angle));
             }
-            return result;
-        };
-    
-    auto ret = matrix::transpose(perform_row_fft(
-        matrix::transpose(
-            perform_row_fft(input, width, height), width), height, width), height);
-    assert(ret.size() == input.size());
-    return ret;
+        }
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    //in place; the inverse transform is scaled by 1 / size
+    void execute(std::complex<T>* data, bool is_inverse) const
+    {
+        FFT_INSTRUMENT_TRANSFORM(size_);
+        if (size_ == 1) return;
+        {
+            FFT_INSTRUMENT_STAGE(permutation);
+            impl::bit_reverse_permute(data, permutation_);
+        }
+        execute_permuted(data, is_inverse);
+    }
+
+    //forward transform of input[i] * window[i] into output, the windowing done
+    //by the pass which writes the values to their bit reversed positions
+    void execute(const std::complex<T>* input, const T* window, std::complex<T>* output) const
+    {
+        FFT_INSTRUMENT_TRANSFORM(size_);
+        {
+            FFT_INSTRUMENT_STAGE(permutation);
+            for (auto i = size_t(0); i < size_; ++i)
+                output[permutation_[i]] = input[i] * window[i];
+        }
+        execute_permuted(output, false);
+    }
+
+    //Transform of input[0, count) followed by zeros into output. Bit reversal puts
+    //the first used = count (rounded up to a power of two) inputs at multiples of
+    //blocks = size / used with zeros between them, so the first log2 blocks passes
+    //would only spread every value over its block; filling the blocks does it instead.
+    void execute_pruned(const std::complex<T>* input, size_t count, std::complex<T>* output,
+                        bool is_inverse) const
+    {
+        FFT_INSTRUMENT_TRANSFORM(size_);
+        auto used = size_t(1);
+        while (used < std::min(count, size_)) used *= 2;
+        auto blocks = size_ / used;
+        {
+            FFT_INSTRUMENT_STAGE(permutation);
+            for (auto i = size_t(0); i < used; ++i)
+            {
+                auto value = (i < count) ? input[i] : std::complex<T>();
+                std::fill(output + permutation_[i], output + permutation_[i] + blocks, value);
+            }
+        }
+        auto values = reinterpret_cast<T*>(output);
+        {
+            FFT_INSTRUMENT_STAGE(butterflies);
+            if (is_inverse)
+                impl::butterflies<true>(values, size_, twiddles_re_.data(), twiddles_im_.data(), blocks);
+            else
+                impl::butterflies<false>(values, size_, twiddles_re_.data(), twiddles_im_.data(), blocks);
+        }
+        if (is_inverse) scale(values, 0, size_);
+    }
+
+    //In place transform of which only data[(first + j) % size()] for j < count are
+    //computed, the rest is left undefined. Once the blocks of a pass are longer than
+    //the band, it runs only the butterflies producing the residues the band needs.
+    void execute_band(std::complex<T>* data, size_t first, size_t count, bool is_inverse) const
+    {
+        FFT_INSTRUMENT_TRANSFORM(size_);
+        count = std::min(count, size_);
+        {
+            FFT_INSTRUMENT_STAGE(permutation);
+            impl::bit_reverse_permute(data, permutation_);
+        }
+        auto values = reinterpret_cast<T*>(data);
+        auto full = size_t(1);
+        while (full < count) full *= 2;
+        {
+            FFT_INSTRUMENT_STAGE(butterflies);
+            if (is_inverse)
+                band_passes<true>(values, full, first, count);
+            else
+                band_passes<false>(values, full, first, count);
+        }
+        if (not is_inverse) return;
+        first %= size_;
+        scale(values, first, std::min(first + count, size_));
+        if (first + count > size_) scale(values, 0, first + count - size_);
+    }
+
+    //element i goes to permutation()[i] before the butterflies
+    const memory::huge_vector<size_t>& permutation() const
+    {
+        return permutation_;
+    }
+
+    //execute over data already in bit reversed order, for callers which write
+    //their input there directly instead of paying for a separate permutation pass
+    void execute_permuted(std::complex<T>* data, bool is_inverse) const
+    {
+        if (size_ == 1) return;
+        //std::complex<T> is guaranteed to be laid out as T[2]
+        auto values = reinterpret_cast<T*>(data);
+        {
+            FFT_INSTRUMENT_STAGE(butterflies);
+            if (is_inverse)
+                impl::butterflies<true>(values, size_, twiddles_re_.data(), twiddles_im_.data());
+            else
+                impl::butterflies<false>(values, size_, twiddles_re_.data(), twiddles_im_.data());
+        }
+        if (is_inverse) scale(values, 0, size_);
+    }
+
+private:
+    //multiplies the elements [begin, end) by 1 / size
+    void scale(T* values, size_t begin, size_t end) const
+    {
+        FFT_INSTRUMENT_STAGE(scaling);
+        auto factor = T(1) / T(size_);
+        for (auto i = 2 * begin; i < 2 * end; ++i)
+            values[i] *= factor;
+    }
+
+    template <bool is_inverse>
+    void band_passes(T* values, size_t full, size_t first, size_t count) const
+    {
+        auto re = twiddles_re_.data(), im = twiddles_im_.data();
+        impl::butterflies<is_inverse>(values, size_, re, im, 1, std::min(full, size_));
+        for (auto half = std::max<size_t>(full, 1); half < size_; half *= 2)
+        {
+            //butterfly j of the pass gives the outputs j and j + half of every block
+            auto begin = first % half, end = begin + count;
+            if (end <= half)
+                impl::butterfly_pass<is_inverse>(values, size_, half, re, im, begin, end);
+            else
+            {
+                impl::butterfly_pass<is_inverse>(values, size_, half, re, im, begin, half);
+                impl::butterfly_pass<is_inverse>(values, size_, half, re, im, 0, end - half);
+            }
+        }
+    }
+
+    size_t size_;
+    memory::huge_vector<size_t> permutation_;
+    memory::huge_vector<T> twiddles_re_;
+    memory::huge_vector<T> twiddles_im_;
+};
+
+//Transform of size real values through a complex one of size / 2: even and odd
+//samples are packed into real and imaginary parts, written straight to their bit
+//reversed positions (and multiplied by a window on the way, when one is given),
+//and the two interleaved half spectra are separated afterwards. Only the
+//size / 2 + 1 bins not implied by conjugate symmetry are produced.
+template <typename T>
+class real_plan
+{
+public:
+    explicit real_plan(size_t size)
+        : size_(size),
+          half_(std::max<size_t>(size / 2, 1)),
+          twiddles_(size / 2)
+    {
+        if ((size < 2) or not impl::is_power_of_2(size))
+            throw std::runtime_error("real fft size has to be a power of two of at least 2");
+
+        static const long double pi = 3.141592653589793238462643383279502884L;
+        for (auto k = size_t(0); k < size / 2; ++k)
+        {
+            auto angle = -2 * pi * (long double)(k) / (long double)(size);
+            twiddles_[k] = std::complex<T>(T(std::cos(angle)), T(std::sin(angle)));
+        }
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    size_t bins() const
+    {
+        return size_ / 2 + 1;
+    }
+
+    //reads count <= size() samples, the missing ones are zeros, multiplied by
+    //window[i] unless window is null; writes bins() values to output
+    void execute(const T* input, size_t count, const T* window, std::complex<T>* output) const
+    {
+        FFT_INSTRUMENT_TRANSFORM(size_);
+        if (window == nullptr)
+            pack(input, count, [](size_t) { return T(1); }, output);
+        else
+            pack(input, count, [window](size_t i) { return window[i]; }, output);
+        half_.execute_permuted(output, false);
+        separate(output);
+    }
+
+    void execute(const T* input, std::complex<T>* output) const
+    {
+        execute(input, size_, nullptr, output);
+    }
+
+    //size() samples from bins() values, scaled by 1 / size(); output is used as
+    //the scratch of the half size transform
+    void inverse(const std::complex<T>* input, T* output) const
+    {
+        FFT_INSTRUMENT_TRANSFORM(size_);
+        auto half = half_.size();
+        auto& order = half_.permutation();
+        auto packed = reinterpret_cast<std::complex<T>*>(output);
+        for (auto k = size_t(0); k < half; ++k)
+        {
+            auto a = input[k], b = std::conj(input[half - k]);
+            auto even = (a + b) * T(0.5);
+            auto odd = (a - b) * T(0.5) * std::conj(twiddles_[k]);
+            packed[order[k]] = even + std::complex<T>(-odd.imag(), odd.real());
+        }
+        half_.execute_permuted(packed, true);
+    }
+
+private:
+    template <typename Window>
+    void pack(const T* input, size_t count, Window window, std::complex<T>* output) const
+    {
+        auto& order = half_.permutation();
+        auto pairs = std::min(count, size_) / 2;
+        for (auto j = size_t(0); j < pairs; ++j)
+            output[order[j]] = std::complex<T>(input[2 * j] * window(2 * j),
+                                               input[2 * j + 1] * window(2 * j + 1));
+        auto j = pairs;
+        if ((count < size_) and (count % 2 == 1))
+        {
+            output[order[j]] = std::complex<T>(input[2 * j] * window(2 * j), T(0));
+            ++j;
+        }
+        for (; j < half_.size(); ++j)
+            output[order[j]] = std::complex<T>();
+    }
+
+    //X[k] = E[k] + w^k O[k], with E = (Z[k] + conj Z[h - k]) / 2 and O = (Z[k] - conj Z[h - k]) / 2i
+    void separate(std::complex<T>* values) const
+    {
+        auto half = half_.size();
+        auto first = values[0];
+        values[0] = std::complex<T>(first.real() + first.imag(), T(0));
+        values[half] = std::complex<T>(first.real() - first.imag(), T(0));
+        for (auto k = size_t(1); 2 * k <= half; ++k)
+        {
+            auto a = values[k], b = values[half - k];
+            values[k] = combine(a, b, twiddles_[k]);
+            values[half - k] = combine(b, a, twiddles_[half - k]);
+        }
+    }
+
+    static std::complex<T> combine(std::complex<T> a, std::complex<T> b, std::complex<T> twiddle)
+    {
+        auto even = (a + std::conj(b)) * T(0.5);
+        auto diff = (a - std::conj(b)) * T(0.5);
+        auto odd = std::complex<T>(diff.imag(), -diff.real());
+        return even + twiddle * odd;
+    }
+
+    size_t size_;
+    plan<T> half_;
+    std::vector<std::complex<T>> twiddles_;
+};
+
+namespace impl
+{
+
+//Plans up to this size are kept per thread. Of the bigger ones, whose tables take
+//gigabytes at 2^26 points, every thread keeps only the one it used last.
+const size_t cached_plan_max_size = 1u << 20;
+
+template <typename Plan>
+const Plan& cached(size_t size)
+{
+    static thread_local std::map<size_t, std::unique_ptr<Plan>> cache;
+    auto& ret = cache[size];
+    if (ret)
+        FFT_INSTRUMENT_COUNT(plan_cache_hits, 1);
+    else
+        ret.reset(new Plan(size));
+    return *ret;
+}
+
+template <typename T>
+const plan<T>& cached_plan(size_t size)
+{
+    return cached<plan<T>>(size);
+}
+
+//Plan of the given size; held shares a big plan, keeping it alive for the caller
+//even when the thread builds another one meanwhile.
+template <typename Plan>
+const Plan& cached_or_built(size_t size, std::shared_ptr<const Plan>& held)
+{
+    if (size <= cached_plan_max_size)
+        return cached<Plan>(size);
+    static thread_local std::shared_ptr<const Plan> last;
+    if (last and (last->size() == size))
+        FFT_INSTRUMENT_COUNT(plan_cache_hits, 1);
+    else
+        last = std::make_shared<const Plan>(size);
+    held = last;
+    return *held;
+}
+
+template <typename T>
+const plan<T>& plan_for(size_t size, std::shared_ptr<const plan<T>>& held)
+{
+    return cached_or_built(size, held);
+}
+
+template <typename T>
+const real_plan<T>& real_plan_for(size_t size, std::shared_ptr<const real_plan<T>>& held)
+{
+    return cached_or_built(size, held);
+}
+
+template <bool is_inverse, typename T>
+ComplexVec<T> fft_impl(ComplexVec<T> input)
+{
+    if (input.size() <= 1) return input;
+    std::shared_ptr<const plan<T>> held;
+    plan_for<T>(input.size(), held).execute(input.data(), is_inverse);
+    return input;
+}
+
+//Rows are transformed in place, columns as rows of a transposed copy kept in
+//a workspace of the calling thread.
+template <bool is_inverse, typename T>
+void transform_2d(std::complex<T>* data, size_t width, size_t height)
+{
+    if (width * height <= 1) return;
+
+    std::shared_ptr<const plan<T>> held_rows, held_columns;
+    auto& rows = plan_for<T>(width, held_rows);
+    auto& columns = plan_for<T>(height, held_columns);
+
+    memory::workspace<std::complex<T>> transposed(width * height);
+    for (auto row = size_t(0); row < height; ++row)
+        rows.execute(data + row * width, is_inverse);
+    matrix::transpose(data, width, height, transposed.data());
+    for (auto col = size_t(0); col < width; ++col)
+        columns.execute(transposed.data() + col * height, is_inverse);
+    matrix::transpose(transposed.data(), height, width, data);
+}
+
+template <bool is_inverse, typename T>
+ComplexVec<T> fft_2d_impl(ComplexVec<T> input, size_t width)
+{
+    transform_2d<is_inverse>(input.data(), width, input.size() / width);
+    return input;
 }
 
 } //namespace impl
@@ -77,13 +502,13 @@ ComplexVec<T> fft_2d_impl(ComplexVec<T> input, size_t width)
 template <typename T>
 ComplexVec<T> fft(ComplexVec<T> input)
 {
-    return impl::fft_impl<false, true>(input);
+    return impl::fft_impl<false>(input);
 }
 
 template <typename T>
 auto inv_fft(ComplexVec<T> input) -> decltype(input)
 {
-    return impl::fft_impl<true, true>(input);
+    return impl::fft_impl<true>(input);
 }
 
 template <typename T>
@@ -98,5 +523,115 @@ auto inv_fft_2d(ComplexVec<T> input, size_t width) -> decltype(input)
     return impl::fft_2d_impl<true>(input, width);
 }
 
-} //namespace fft
+//in place over caller owned memory, e.g. a memory mapped spectrum_file
+template <typename T>
+void fft_in_place(std::complex<T>* data, size_t size)
+{
+    std::shared_ptr<const plan<T>> held;
+    impl::plan_for<T>(size, held).execute(data, false);
+}
 
+template <typename T>
+void inv_fft_in_place(std::complex<T>* data, size_t size)
+{
+    std::shared_ptr<const plan<T>> held;
+    impl::plan_for<T>(size, held).execute(data, true);
+}
+
+//in place over a row major width x height matrix, e.g. in a memory::huge_vector
+template <typename T>
+void fft_2d_in_place(std::complex<T>* data, size_t width, size_t height)
+{
+    impl::transform_2d<false>(data, width, height);
+}
+
+template <typename T>
+void inv_fft_2d_in_place(std::complex<T>* data, size_t width, size_t height)
+{
+    impl::transform_2d<true>(data, width, height);
+}
+
+namespace impl
+{
+
+template <bool is_inverse, typename T>
+ComplexVec<T> input_pruned(const ComplexVec<T>& input, size_t size)
+{
+    if (input.size() > size)
+        throw std::runtime_error("pruned fft input is longer than the transform");
+    ComplexVec<T> ret(size);
+    std::shared_ptr<const plan<T>> held;
+    plan_for<T>(size, held).execute_pruned(input.data(), input.size(), ret.data(), is_inverse);
+    return ret;
+}
+
+template <bool is_inverse, typename T>
+ComplexVec<T> output_pruned(ComplexVec<T> input, size_t first, size_t count)
+{
+    std::shared_ptr<const plan<T>> held;
+    plan_for<T>(input.size(), held).execute_band(input.data(), first, count, is_inverse);
+    ComplexVec<T> ret(std::min(count, input.size()));
+    for (auto j = size_t(0); j < ret.size(); ++j)
+        ret[j] = input[(first + j) % input.size()];
+    return ret;
+}
+
+} //namespace impl
+
+//transform of input zero padded to size, without the butterflies over the padding
+template <typename T>
+ComplexVec<T> fft_input_pruned(const ComplexVec<T>& input, size_t size)
+{
+    return impl::input_pruned<false>(input, size);
+}
+
+template <typename T>
+ComplexVec<T> inv_fft_input_pruned(const ComplexVec<T>& input, size_t size)
+{
+    return impl::input_pruned<true>(input, size);
+}
+
+//the count values from first on (modulo the size) of the transform of input
+template <typename T>
+ComplexVec<T> fft_output_pruned(ComplexVec<T> input, size_t first, size_t count)
+{
+    return impl::output_pruned<false>(std::move(input), first, count);
+}
+
+template <typename T>
+ComplexVec<T> inv_fft_output_pruned(ComplexVec<T> input, size_t first, size_t count)
+{
+    return impl::output_pruned<true>(std::move(input), first, count);
+}
+
+//the size / 2 + 1 non negative frequency bins of a real signal
+template <typename T>
+ComplexVec<T> real_fft(const std::vector<T>& input)
+{
+    if (input.size() <= 1)
+        return ComplexVec<T>(input.begin(), input.end());
+    std::shared_ptr<const real_plan<T>> held;
+    auto& transform = impl::real_plan_for<T>(input.size(), held);
+    ComplexVec<T> ret(transform.bins());
+    transform.execute(input.data(), ret.data());
+    return ret;
+}
+
+//inverse of real_fft, the signal has 2 * (input.size() - 1) samples
+template <typename T>
+std::vector<T> inv_real_fft(const ComplexVec<T>& input)
+{
+    if (input.size() <= 1)
+    {
+        std::vector<T> ret;
+        for (auto& value : input) ret.push_back(value.real());
+        return ret;
+    }
+    std::shared_ptr<const real_plan<T>> held;
+    auto& transform = impl::real_plan_for<T>(2 * (input.size() - 1), held);
+    std::vector<T> ret(transform.size());
+    transform.inverse(input.data(), ret.data());
+    return ret;
+}
+
+} //namespace fft
@@ -0,0 +1,375 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <complex>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <stdexcept>
+#include "fft.hpp"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+//Integer transforms of int16_t and int32_t samples with block floating point: before
+//every radix-2 pass the whole block is shifted right just enough for the butterflies
+//not to overflow, and the shifts are reported as a common exponent. Twiddles are Q15
+//(Q31 for int32_t) and every addition saturates.
+
+namespace fixed
+{
+
+template <typename T>
+struct complex
+{
+    T re;
+    T im;
+
+    complex() : re(0), im(0) {}
+    complex(T re, T im) : re(re), im(im) {}
+};
+
+template <typename T>
+using ComplexVec = std::vector<complex<T>>;
+
+//the transform equals values * 2^exponent
+template <typename T>
+struct spectrum
+{
+    ComplexVec<T> values;
+    int exponent;
+};
+
+namespace detail
+{
+
+template <typename T>
+struct traits;
+
+//Components at most headroom keep the butterfly outputs below
+//headroom * (1 + sqrt(2)), inside the range of T.
+template <>
+struct traits<int16_t>
+{
+    using wide = int32_t;
+    static const int fraction_bits = 15;
+    static const wide headroom = 1 << 13;
+};
+
+template <>
+struct traits<int32_t>
+{
+    using wide = int64_t;
+    static const int fraction_bits = 31;
+    static const wide headroom = wide(1) << 29;
+};
+
+template <typename T, typename Wide>
+T saturate(Wide value)
+{
+    return T(std::max<Wide>(std::numeric_limits<T>::min(),
+                            std::min<Wide>(std::numeric_limits<T>::max(), value)));
+}
+
+//symmetric, so that the negated twiddles fit as well
+template <typename T>
+T quantize(long double value)
+{
+    auto limit = (long long)(std::numeric_limits<T>::max());
+    auto ret = std::llround(std::ldexp(value, traits<T>::fraction_bits));
+    return T(std::max(-limit, std::min(limit, ret)));
+}
+
+template <typename T>
+typename traits<T>::wide largest_component(const T* values, size_t count)
+{
+    using wide = typename traits<T>::wide;
+    wide ret = 0;
+    for (auto i = size_t(0); i < count; ++i)
+        ret = std::max(ret, std::abs(wide(values[i])));
+    return ret;
+}
+
+template <typename T>
+void conjugate(T* values, size_t size)
+{
+    using wide = typename traits<T>::wide;
+    for (auto i = size_t(1); i < 2 * size; i += 2)
+        values[i] = saturate<T>(-wide(values[i]));
+}
+
+//Radix-2 pass over interleaved values combining blocks of half elements, every input
+//first rounded and shifted right by shift bits. Twiddle j multiplies as two dot
+//products: with (w_re, -w_im) for the real and with (w_im, w_re) for the imaginary
+//part. Returns the largest magnitude of an output component.
+template <typename T>
+typename traits<T>::wide pass(T* values, size_t size, size_t half,
+                              const T* real_parts, const T* imaginary_parts, int shift)
+{
+    using wide = typename traits<T>::wide;
+    auto rounding = wide(1) << (traits<T>::fraction_bits - 1);
+    auto shift_rounding = (wide(1) << shift) >> 1;
+    wide largest = 0;
+    for (auto block = size_t(0); block < size; block += 2 * half)
+    {
+        for (auto j = size_t(0); j < half; ++j)
+        {
+            auto a = values + 2 * (block + j);
+            auto b = a + 2 * half;
+            auto a_re = (wide(a[0]) + shift_rounding) >> shift;
+            auto a_im = (wide(a[1]) + shift_rounding) >> shift;
+            auto b_re = (wide(b[0]) + shift_rounding) >> shift;
+            auto b_im = (wide(b[1]) + shift_rounding) >> shift;
+            //the first pass multiplies by one only, which Q15 cannot represent
+            auto t_re = b_re, t_im = b_im;
+            if (half > 1)
+            {
+                t_re = (b_re * real_parts[2 * j] + b_im * real_parts[2 * j + 1] + rounding)
+                     >> traits<T>::fraction_bits;
+                t_im = (b_re * imaginary_parts[2 * j] + b_im * imaginary_parts[2 * j + 1] + rounding)
+                     >> traits<T>::fraction_bits;
+            }
+            a[0] = saturate<T>(a_re + t_re);
+            a[1] = saturate<T>(a_im + t_im);
+            b[0] = saturate<T>(a_re - t_re);
+            b[1] = saturate<T>(a_im - t_im);
+            largest = std::max(largest, std::max(std::max(std::abs(wide(a[0])), std::abs(wide(a[1]))),
+                                                 std::max(std::abs(wide(b[0])), std::abs(wide(b[1])))));
+        }
+    }
+    return largest;
+}
+
+#ifdef __SSE2__
+//Four complex values per step: _mm_madd_epi16 forms both dot products of a twiddle
+//multiplication, _mm_packs_epi32 and _mm_adds_epi16 / _mm_subs_epi16 saturate.
+inline int32_t pass_sse2(int16_t* values, size_t size, size_t half,
+                         const int16_t* real_parts, const int16_t* imaginary_parts, int shift)
+{
+    auto count = _mm_cvtsi32_si128(shift);
+    auto shift_rounding = _mm_set1_epi16(int16_t((1 << shift) >> 1));
+    auto rounding = _mm_set1_epi32(1 << 14);
+    auto largest = _mm_setzero_si128(), smallest = _mm_setzero_si128();
+    for (auto block = size_t(0); block < size; block += 2 * half)
+    {
+        for (auto j = size_t(0); j < half; j += 4)
+        {
+            auto a_ptr = reinterpret_cast<__m128i*>(values + 2 * (block + j));
+            auto b_ptr = reinterpret_cast<__m128i*>(values + 2 * (block + j + half));
+            auto a = _mm_sra_epi16(_mm_adds_epi16(_mm_loadu_si128(a_ptr), shift_rounding), count);
+            auto b = _mm_sra_epi16(_mm_adds_epi16(_mm_loadu_si128(b_ptr), shift_rounding), count);
+            auto w_re = _mm_loadu_si128(reinterpret_cast<const __m128i*>(real_parts + 2 * j));
+            auto w_im = _mm_loadu_si128(reinterpret_cast<const __m128i*>(imaginary_parts + 2 * j));
+            auto t_re = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(b, w_re), rounding), 15);
+            auto t_im = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(b, w_im), rounding), 15);
+            auto t = _mm_packs_epi32(_mm_unpacklo_epi32(t_re, t_im), _mm_unpackhi_epi32(t_re, t_im));
+            auto sum = _mm_adds_epi16(a, t);
+            auto difference = _mm_subs_epi16(a, t);
+            _mm_storeu_si128(a_ptr, sum);
+            _mm_storeu_si128(b_ptr, difference);
+            largest = _mm_max_epi16(largest, _mm_max_epi16(sum, difference));
+            smallest = _mm_min_epi16(smallest, _mm_min_epi16(sum, difference));
+        }
+    }
+    int16_t maxima[8], minima[8];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(maxima), largest);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(minima), smallest);
+    int32_t ret = 0;
+    for (auto i = 0u; i < 8; ++i)
+        ret = std::max(ret, std::max(int32_t(maxima[i]), -int32_t(minima[i])));
+    return ret;
+}
+#endif
+
+#ifdef __AVX2__
+//the same with eight complex values; every instruction works within 128 bit lanes,
+//which keeps the unpack and pack order of the SSE2 version
+inline int32_t pass_avx2(int16_t* values, size_t size, size_t half,
+                         const int16_t* real_parts, const int16_t* imaginary_parts, int shift)
+{
+    auto count = _mm_cvtsi32_si128(shift);
+    auto shift_rounding = _mm256_set1_epi16(int16_t((1 << shift) >> 1));
+    auto rounding = _mm256_set1_epi32(1 << 14);
+    auto largest = _mm256_setzero_si256(), smallest = _mm256_setzero_si256();
+    for (auto block = size_t(0); block < size; block += 2 * half)
+    {
+        for (auto j = size_t(0); j < half; j += 8)
+        {
+            auto a_ptr = reinterpret_cast<__m256i*>(values + 2 * (block + j));
+            auto b_ptr = reinterpret_cast<__m256i*>(values + 2 * (block + j + half));
+            auto a = _mm256_sra_epi16(_mm256_adds_epi16(_mm256_loadu_si256(a_ptr), shift_rounding), count);
+            auto b = _mm256_sra_epi16(_mm256_adds_epi16(_mm256_loadu_si256(b_ptr), shift_rounding), count);
+            auto w_re = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(real_parts + 2 * j));
+            auto w_im = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(imaginary_parts + 2 * j));
+            auto t_re = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(b, w_re), rounding), 15);
+            auto t_im = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(b, w_im), rounding), 15);
+            auto t = _mm256_packs_epi32(_mm256_unpacklo_epi32(t_re, t_im), _mm256_unpackhi_epi32(t_re, t_im));
+            auto sum = _mm256_adds_epi16(a, t);
+            auto difference = _mm256_subs_epi16(a, t);
+            _mm256_storeu_si256(a_ptr, sum);
+            _mm256_storeu_si256(b_ptr, difference);
+            largest = _mm256_max_epi16(largest, _mm256_max_epi16(sum, difference));
+            smallest = _mm256_min_epi16(smallest, _mm256_min_epi16(sum, difference));
+        }
+    }
+    int16_t maxima[16], minima[16];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(maxima), largest);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(minima), smallest);
+    int32_t ret = 0;
+    for (auto i = 0u; i < 16; ++i)
+        ret = std::max(ret, std::max(int32_t(maxima[i]), -int32_t(minima[i])));
+    return ret;
+}
+#endif
+
+inline int32_t pass(int16_t* values, size_t size, size_t half,
+                    const int16_t* real_parts, const int16_t* imaginary_parts, int shift)
+{
+#ifdef __AVX2__
+    if (half >= 8)
+        return pass_avx2(values, size, half, real_parts, imaginary_parts, shift);
+#endif
+#ifdef __SSE2__
+    if (half >= 4)
+        return pass_sse2(values, size, half, real_parts, imaginary_parts, shift);
+#endif
+    return pass<int16_t>(values, size, half, real_parts, imaginary_parts, shift);
+}
+
+} //namespace detail
+
+//Precomputed bit reversal permutation and quantized twiddles for one power of two size.
+template <typename T>
+class plan
+{
+public:
+    explicit plan(size_t size)
+        : size_(size),
+          permutation_(fft::impl::bit_reversal_table(size)),
+          real_parts_(2 * size),
+          imaginary_parts_(2 * size)
+    {
+        if (not fft::impl::is_power_of_2(size))
+            throw std::runtime_error("fft size has to be a power of two");
+
+        FFT_INSTRUMENT_COUNT(plans_created, 1);
+        FFT_INSTRUMENT_COUNT(twiddle_tables_computed, 1);
+        FFT_INSTRUMENT_ALLOCATION(size * 4 * sizeof(T));
+
+        static const long double pi = 3.141592653589793238462643383279502884L;
+        for (auto half = size_t(1); half < size; half *= 2)
+        {
+            for (auto j = size_t(0); j < half; ++j)
+            {
+                auto angle = -pi * (long double)(j) / (long double)(half);
+                auto w_re = detail::quantize<T>(std::cos(angle));
+                auto w_im = detail::quantize<T>(std::sin(angle));
+                real_parts_[2 * (half + j)] = w_re;
+                real_parts_[2 * (half + j) + 1] = T(-w_im);
+                imaginary_parts_[2 * (half + j)] = w_im;
+                imaginary_parts_[2 * (half + j) + 1] = w_re;
+            }
+        }
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    //In place; returns the exponent e for which the transform equals data * 2^e.
+    //The inverse transform is scaled by 1 / size, which only lowers the exponent.
+    int execute(complex<T>* data, bool is_inverse) const
+    {
+        FFT_INSTRUMENT_TRANSFORM(size_);
+        //complex<T> is two T members, laid out like T[2]
+        auto values = reinterpret_cast<T*>(data);
+        if (is_inverse) detail::conjugate(values, size_);
+        {
+            FFT_INSTRUMENT_STAGE(permutation);
+            fft::impl::bit_reverse_permute(data, permutation_);
+        }
+
+        auto exponent = 0;
+        {
+            FFT_INSTRUMENT_STAGE(butterflies);
+            auto largest = detail::largest_component(values, 2 * size_);
+            for (auto half = size_t(1); half < size_; half *= 2)
+            {
+                auto shift = 0;
+                while ((largest >> shift) > detail::traits<T>::headroom) ++shift;
+                exponent += shift;
+                largest = detail::pass(values, size_, half, real_parts_.data() + 2 * half,
+                                       imaginary_parts_.data() + 2 * half, shift);
+            }
+        }
+
+        if (not is_inverse) return exponent;
+        detail::conjugate(values, size_);
+        for (auto rest = size_; rest > 1; rest /= 2) --exponent;
+        return exponent;
+    }
+
+private:
+    size_t size_;
+    memory::huge_vector<size_t> permutation_;
+    std::vector<T> real_parts_;
+    std::vector<T> imaginary_parts_;
+};
+
+namespace detail
+{
+
+template <typename T>
+spectrum<T> transform(ComplexVec<T> input, int exponent, bool is_inverse)
+{
+    spectrum<T> ret = {std::move(input), exponent};
+    if (ret.values.size() <= 1) return ret;
+    std::shared_ptr<const plan<T>> held;
+    auto& transform = fft::impl::cached_or_built<plan<T>>(ret.values.size(), held);
+    ret.exponent += transform.execute(ret.values.data(), is_inverse);
+    return ret;
+}
+
+} //namespace detail
+
+template <typename T>
+spectrum<T> fft(ComplexVec<T> input)
+{
+    return detail::transform(std::move(input), 0, false);
+}
+
+//real samples, e.g. straight from an ADC
+template <typename T>
+spectrum<T> fft(const std::vector<T>& samples)
+{
+    ComplexVec<T> input(samples.size());
+    for (auto i = 0u; i < samples.size(); ++i)
+        input[i].re = samples[i];
+    return fft(std::move(input));
+}
+
+template <typename T>
+spectrum<T> inv_fft(spectrum<T> input)
+{
+    return detail::transform(std::move(input.values), input.exponent, true);
+}
+
+//absolute values of the transform
+template <typename T>
+fft::ComplexVec<double> to_double(const spectrum<T>& arg)
+{
+    fft::ComplexVec<double> ret(arg.values.size());
+    for (auto i = 0u; i < ret.size(); ++i)
+        ret[i] = std::complex<double>(std::ldexp(double(arg.values[i].re), arg.exponent),
+                                      std::ldexp(double(arg.values[i].im), arg.exponent));
+    return ret;
+}
+
+} //namespace fixed
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include <stdexcept>
+#include "fft.hpp"
+
+//Single frequencies of a real signal with the Goertzel recurrence
+//s[n] = x[n] + 2 cos(w) s[n - 1] - s[n - 2], one multiplication per sample and bin.
+//Bins are in units of sample_rate / size and need not be integers. The bins are
+//processed in groups of lanes independent recurrences, which the compiler keeps
+//in vector registers, so that several bins share every pass over the samples.
+
+namespace goertzel
+{
+
+//recurrences run together; the last few bins go in a narrower group
+const size_t lanes = 32;
+const size_t narrow_lanes = 8;
+
+enum class method
+{
+    goertzel,
+    fft
+};
+
+//Costs in units of one pass of fft butterflies over the data, as measured with
+//SSE2: every group of recurrences holds up the samples as long as about 8 passes,
+//except that wide groups of double spill registers and take about 16. The real
+//fft of a power of two size makes log2 size passes; other sizes would need the
+//next power of two.
+template <typename T>
+double goertzel_cost(size_t size, size_t bins)
+{
+    auto wide = size_t(0), narrow = size_t(0), group = size_t(0);
+    for (; group + narrow_lanes < bins; group += lanes) ++wide;
+    for (; group < bins; group += narrow_lanes) ++narrow;
+    return double(size) * (8.0 * double(narrow) + 2.0 * double(sizeof(T)) * double(wide));
+}
+
+inline double fft_cost(size_t size)
+{
+    auto padded = size_t(2);
+    while (padded < size) padded *= 2;
+    return double(padded) * std::log2(double(padded));
+}
+
+template <typename T>
+method cheaper(size_t size, size_t bins)
+{
+    return (goertzel_cost<T>(size, bins) < fft_cost(size)) ? method::goertzel : method::fft;
+}
+
+template <typename T>
+class plan
+{
+public:
+    plan(size_t size, const std::vector<double>& bins)
+        : size_(size), bins_(bins)
+    {
+        if (size == 0)
+            throw std::runtime_error("goertzel size has to be positive");
+        static const long double pi = 3.141592653589793238462643383279502884L;
+        coefficients_.assign(bins.size() + lanes, T(0));
+        for (auto i = size_t(0); i < bins.size(); ++i)
+        {
+            auto omega = 2 * pi * (long double)(bins[i]) / (long double)(size);
+            coefficients_[i] = T(2 * std::cos(omega));
+            //y = s[N - 1] - exp(-i w) s[N - 2], X = exp(-i w (N - 1)) y
+            delay_.push_back(std::complex<T>(T(std::cos(omega)), T(-std::sin(omega))));
+            auto phase = -omega * (long double)(size - 1);
+            rotation_.push_back(std::complex<T>(T(std::cos(phase)), T(std::sin(phase))));
+        }
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    const std::vector<double>& bins() const
+    {
+        return bins_;
+    }
+
+    //sum of input[n] exp(-2 pi i bins()[j] n / size()) into output[j]
+    void execute(const T* input, std::complex<T>* output) const
+    {
+        auto group = size_t(0);
+        for (; group + narrow_lanes < bins_.size(); group += lanes)
+            run<lanes>(input, group, output);
+        for (; group < bins_.size(); group += narrow_lanes)
+            run<narrow_lanes>(input, group, output);
+    }
+
+    fft::ComplexVec<T> execute(const std::vector<T>& input) const
+    {
+        if (input.size() != size_)
+            throw std::runtime_error("goertzel input size differs from the plan");
+        fft::ComplexVec<T> ret(bins_.size());
+        execute(input.data(), ret.data());
+        return ret;
+    }
+
+private:
+    template <size_t width>
+    void run(const T* input, size_t group, std::complex<T>* output) const
+    {
+        const T* coefficient = coefficients_.data() + group;
+        T previous[width] = {}, before[width] = {};
+        for (auto n = size_t(0); n < size_; ++n)
+        {
+            auto x = input[n];
+            for (auto l = size_t(0); l < width; ++l)
+            {
+                auto current = x + coefficient[l] * previous[l] - before[l];
+                before[l] = previous[l];
+                previous[l] = current;
+            }
+        }
+        for (auto l = size_t(0); (l < width) and (group + l < bins_.size()); ++l)
+        {
+            auto j = group + l;
+            output[j] = rotation_[j] * (std::complex<T>(previous[l]) - delay_[j] * before[l]);
+        }
+    }
+
+    size_t size_;
+    std::vector<double> bins_;
+    std::vector<T> coefficients_;
+    std::vector<std::complex<T>> delay_;
+    std::vector<std::complex<T>> rotation_;
+};
+
+//The chosen bins of input by Goertzel, or by the real fft where cheaper() says so
+//and it can (power of two size, integer bins).
+template <typename T>
+fft::ComplexVec<T> evaluate(const std::vector<T>& input, const std::vector<double>& bins)
+{
+    auto integral = std::all_of(bins.begin(), bins.end(), [](double bin) { return bin == std::floor(bin); });
+    if (integral and (input.size() > 1) and fft::impl::is_power_of_2(input.size())
+        and (cheaper<T>(input.size(), bins.size()) == method::fft))
+    {
+        auto spectrum = fft::real_fft(input);
+        auto size = long(input.size());
+        fft::ComplexVec<T> ret;
+        for (auto bin : bins)
+        {
+            auto k = ((long(bin) % size) + size) % size;
+            ret.push_back((k < long(spectrum.size())) ? spectrum[k] : std::conj(spectrum[size - k]));
+        }
+        return ret;
+    }
+    return plan<T>(input.size(), bins).execute(input);
+}
+
+} //namespace goertzel
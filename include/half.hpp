@@ -0,0 +1,311 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "fft.hpp"
+#include "memory.hpp"
+#include "parallel.hpp"
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+
+//16 bit storage formats for bulk transforms that are limited by memory bandwidth:
+//data is kept as IEEE half precision or bfloat16 and converted to float one line
+//at a time, every transform computes in float. Forward transforms grow the values
+//up to size times, beyond 65504 the half precision results become infinite.
+
+namespace half
+{
+
+namespace detail
+{
+
+inline uint32_t float_bits(float value)
+{
+    uint32_t ret;
+    std::memcpy(&ret, &value, sizeof(ret));
+    return ret;
+}
+
+inline float bits_float(uint32_t bits)
+{
+    float ret;
+    std::memcpy(&ret, &bits, sizeof(ret));
+    return ret;
+}
+
+//Round to nearest, ties to even, without a branch per exponent range: subnormal
+//results are rounded by the float addition of 0.5, which aligns the mantissa.
+inline uint16_t float16_bits(float value)
+{
+    auto bits = float_bits(value);
+    auto sign = bits & 0x80000000u;
+    bits ^= sign;
+    uint32_t ret;
+    //65520 and above round to infinity
+    if (bits >= (143u << 23))
+        ret = (bits > 0x7f800000u) ? 0x7e00u : 0x7c00u;
+    else if (bits < (113u << 23))
+        ret = float_bits(bits_float(bits) + 0.5f) - (126u << 23);
+    else
+        ret = (bits - (112u << 23) + 0xfffu + ((bits >> 13) & 1)) >> 13;
+    return uint16_t(ret | (sign >> 16));
+}
+
+inline float float16_value(uint16_t bits)
+{
+    auto ret = uint32_t(bits & 0x7fffu) << 13;
+    auto exponent = ret & (0x1fu << 23);
+    ret += 112u << 23;
+    if (exponent == (0x1fu << 23))
+        ret += 112u << 23;
+    //subnormals: the implicit bit makes it 2^-14 too big
+    else if (exponent == 0)
+        ret = float_bits(bits_float(ret + (1u << 23)) - bits_float(113u << 23));
+    return bits_float(ret | (uint32_t(bits & 0x8000u) << 16));
+}
+
+//round to nearest, ties to even; NaNs stay quiet NaNs
+inline uint16_t bfloat16_bits(float value)
+{
+    auto bits = float_bits(value);
+    if ((bits & 0x7fffffffu) > 0x7f800000u)
+        return uint16_t((bits >> 16) | 0x40u);
+    return uint16_t((bits + 0x7fffu + ((bits >> 16) & 1)) >> 16);
+}
+
+inline float bfloat16_value(uint16_t bits)
+{
+    return bits_float(uint32_t(bits) << 16);
+}
+
+} //namespace detail
+
+//IEEE 754 binary16: 11 significant bits, range up to 65504
+struct float16
+{
+    uint16_t bits;
+
+    float16() : bits(0) {}
+    explicit float16(float value) : bits(detail::float16_bits(value)) {}
+
+    explicit operator float() const
+    {
+        return detail::float16_value(bits);
+    }
+
+    static float16 from_bits(uint16_t bits)
+    {
+        float16 ret;
+        ret.bits = bits;
+        return ret;
+    }
+};
+
+//upper half of a float: 8 significant bits, the whole float range
+struct bfloat16
+{
+    uint16_t bits;
+
+    bfloat16() : bits(0) {}
+    explicit bfloat16(float value) : bits(detail::bfloat16_bits(value)) {}
+
+    explicit operator float() const
+    {
+        return detail::bfloat16_value(bits);
+    }
+
+    static bfloat16 from_bits(uint16_t bits)
+    {
+        bfloat16 ret;
+        ret.bits = bits;
+        return ret;
+    }
+};
+
+//interleaved like std::complex, which has no specializations for these types
+template <typename Storage>
+struct complex
+{
+    Storage re;
+    Storage im;
+
+    complex() {}
+    complex(Storage re, Storage im) : re(re), im(im) {}
+
+    explicit complex(std::complex<float> value)
+        : re(Storage(value.real())), im(Storage(value.imag()))
+    {}
+
+    explicit operator std::complex<float>() const
+    {
+        return std::complex<float>(float(re), float(im));
+    }
+};
+
+template <typename Storage>
+using ComplexVec = std::vector<complex<Storage>>;
+
+namespace detail
+{
+
+template <typename Storage>
+void load(const complex<Storage>* source, size_t count, size_t stride, std::complex<float>* target)
+{
+    for (auto i = size_t(0); i < count; ++i)
+        target[i] = std::complex<float>(source[i * stride]);
+}
+
+template <typename Storage>
+void store(const std::complex<float>* source, size_t count, complex<Storage>* target, size_t stride)
+{
+    for (auto i = size_t(0); i < count; ++i)
+        target[i * stride] = complex<Storage>(source[i]);
+}
+
+#ifdef __F16C__
+//contiguous half precision lines convert eight values per instruction
+template <>
+inline void load(const complex<float16>* source, size_t count, size_t stride, std::complex<float>* target)
+{
+    if (stride != 1)
+    {
+        for (auto i = size_t(0); i < count; ++i)
+            target[i] = std::complex<float>(source[i * stride]);
+        return;
+    }
+    auto input = reinterpret_cast<const uint16_t*>(source);
+    auto output = reinterpret_cast<float*>(target);
+    auto i = size_t(0);
+    for (; i + 8 <= 2 * count; i += 8)
+    {
+        auto packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        _mm256_storeu_ps(output + i, _mm256_cvtph_ps(packed));
+    }
+    for (; i < 2 * count; ++i)
+        output[i] = float16_value(input[i]);
+}
+
+template <>
+inline void store(const std::complex<float>* source, size_t count, complex<float16>* target, size_t stride)
+{
+    if (stride != 1)
+    {
+        for (auto i = size_t(0); i < count; ++i)
+            target[i * stride] = complex<float16>(source[i]);
+        return;
+    }
+    auto input = reinterpret_cast<const float*>(source);
+    auto output = reinterpret_cast<uint16_t*>(target);
+    auto i = size_t(0);
+    for (; i + 8 <= 2 * count; i += 8)
+    {
+        auto packed = _mm256_cvtps_ph(_mm256_loadu_ps(input + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), packed);
+    }
+    for (; i < 2 * count; ++i)
+        output[i] = float16_bits(input[i]);
+}
+#endif
+
+//Transforms count lines of length elements each, line i starting at data + i * line_stride
+//with its elements element_stride apart. Every thread converts a line into its own
+//float buffer, transforms it there and rounds the result back into place.
+template <typename Storage>
+void transform_lines(complex<Storage>* data, size_t count, size_t length,
+                     size_t element_stride, size_t line_stride,
+                     bool is_inverse, size_t threads)
+{
+    if (length <= 1) return;
+
+    //plans are read only once built, so the threads share one
+    std::shared_ptr<const fft::plan<float>> held;
+    auto& transform = fft::impl::plan_for<float>(length, held);
+
+    parallel::for_ranges(count, threads, [&](size_t begin, size_t end) {
+        memory::workspace<std::complex<float>> buffer(length);
+        for (auto line = begin; line < end; ++line)
+        {
+            auto first = data + line * line_stride;
+            load(first, length, element_stride, buffer.data());
+            transform.execute(buffer.data(), is_inverse);
+            store(buffer.data(), length, first, element_stride);
+        }
+    });
+}
+
+template <typename Storage>
+void transform_2d(ComplexVec<Storage>& data, size_t width, bool is_inverse, size_t threads)
+{
+    if (data.empty()) return;
+    if ((width == 0) or (data.size() % width != 0))
+        throw std::runtime_error("width does not divide the matrix size");
+
+    auto height = data.size() / width;
+    transform_lines(data.data(), height, width, 1, width, is_inverse, threads);
+    transform_lines(data.data(), width, height, width, 1, is_inverse, threads);
+}
+
+template <typename Storage>
+void transform_batch(ComplexVec<Storage>& data, size_t length, bool is_inverse, size_t threads)
+{
+    if (data.empty()) return;
+    if ((length == 0) or (data.size() % length != 0))
+        throw std::runtime_error("batch length does not divide the data size");
+    transform_lines(data.data(), data.size() / length, length, 1, length, is_inverse, threads);
+}
+
+} //namespace detail
+
+template <typename Storage>
+ComplexVec<Storage> fft(ComplexVec<Storage> input)
+{
+    detail::transform_batch(input, input.size(), false, 1);
+    return input;
+}
+
+template <typename Storage>
+ComplexVec<Storage> inv_fft(ComplexVec<Storage> input)
+{
+    detail::transform_batch(input, input.size(), true, 1);
+    return input;
+}
+
+//independent transforms of consecutive blocks of length elements
+template <typename Storage>
+ComplexVec<Storage> fft_batch(ComplexVec<Storage> input, size_t length,
+                              size_t threads = parallel::default_threads())
+{
+    detail::transform_batch(input, length, false, threads);
+    return input;
+}
+
+template <typename Storage>
+ComplexVec<Storage> inv_fft_batch(ComplexVec<Storage> input, size_t length,
+                                  size_t threads = parallel::default_threads())
+{
+    detail::transform_batch(input, length, true, threads);
+    return input;
+}
+
+//the row results are rounded to Storage before the column transforms
+template <typename Storage>
+ComplexVec<Storage> fft_2d(ComplexVec<Storage> input, size_t width,
+                           size_t threads = parallel::default_threads())
+{
+    detail::transform_2d(input, width, false, threads);
+    return input;
+}
+
+template <typename Storage>
+ComplexVec<Storage> inv_fft_2d(ComplexVec<Storage> input, size_t width,
+                               size_t threads = parallel::default_threads())
+{
+    detail::transform_2d(input, width, true, threads);
+    return input;
+}
+
+} //namespace half
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <map>
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <ostream>
+
+//Counters and per stage timers of the library internals. They are collected only
+//when FFT_INSTRUMENTATION is defined (for every translation unit of the program);
+//otherwise the FFT_INSTRUMENT_* hooks expand to nothing and snapshots stay empty.
+
+namespace instrumentation
+{
+
+enum class counter
+{
+    plans_created,
+    plan_cache_hits,
+    twiddle_tables_computed,
+    spectrum_cache_hits,
+    spectrum_cache_misses,
+    allocations,
+    bytes_allocated,
+    count
+};
+
+enum class stage
+{
+    permutation,
+    butterflies,
+    scaling,
+    transpose,
+    spectral_product,
+    count
+};
+
+inline const char* name(counter which)
+{
+    static const char* names[] = {
+        "plans_created", "plan_cache_hits", "twiddle_tables_computed", "spectrum_cache_hits",
+        "spectrum_cache_misses", "allocations", "bytes_allocated"};
+    return names[size_t(which)];
+}
+
+inline const char* name(stage which)
+{
+    static const char* names[] = {
+        "permutation", "butterflies", "scaling", "transpose", "spectral_product"};
+    return names[size_t(which)];
+}
+
+struct stage_time
+{
+    uint64_t calls;
+    uint64_t nanoseconds;
+};
+
+struct snapshot
+{
+    std::array<uint64_t, size_t(counter::count)> counters;
+    std::array<stage_time, size_t(stage::count)> stages;
+    std::map<size_t, uint64_t> transforms_by_size;
+
+    uint64_t operator[](counter which) const
+    {
+        return counters[size_t(which)];
+    }
+
+    const stage_time& operator[](stage which) const
+    {
+        return stages[size_t(which)];
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const snapshot& arg)
+{
+    for (auto i = 0u; i < arg.counters.size(); ++i)
+        out << name(counter(i)) << ": " << arg.counters[i] << "\n";
+    for (auto i = 0u; i < arg.stages.size(); ++i)
+        out << name(stage(i)) << ": " << arg.stages[i].calls << " calls, "
+            << arg.stages[i].nanoseconds << " ns\n";
+    for (auto& entry : arg.transforms_by_size)
+        out << "transforms of size " << entry.first << ": " << entry.second << "\n";
+    return out;
+}
+
+namespace detail
+{
+
+struct registry
+{
+    std::array<std::atomic<uint64_t>, size_t(counter::count)> counters;
+    std::array<std::atomic<uint64_t>, size_t(stage::count)> stage_calls;
+    std::array<std::atomic<uint64_t>, size_t(stage::count)> stage_nanoseconds;
+    std::mutex sizes_mutex;
+    std::map<size_t, uint64_t> transforms_by_size;
+
+    registry()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto& value : counters) value = 0;
+        for (auto& value : stage_calls) value = 0;
+        for (auto& value : stage_nanoseconds) value = 0;
+        std::lock_guard<std::mutex> lock(sizes_mutex);
+        transforms_by_size.clear();
+    }
+};
+
+inline registry& global()
+{
+    static registry ret;
+    return ret;
+}
+
+inline void add(counter which, uint64_t amount)
+{
+    global().counters[size_t(which)].fetch_add(amount, std::memory_order_relaxed);
+}
+
+inline void allocation(uint64_t bytes)
+{
+    add(counter::allocations, 1);
+    add(counter::bytes_allocated, bytes);
+}
+
+inline void transform(size_t size)
+{
+    auto& state = global();
+    std::lock_guard<std::mutex> lock(state.sizes_mutex);
+    ++state.transforms_by_size[size];
+}
+
+class scoped_timer
+{
+public:
+    explicit scoped_timer(stage which)
+        : which_(which), start_(std::chrono::steady_clock::now())
+    {}
+
+    ~scoped_timer()
+    {
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        auto& state = global();
+        state.stage_calls[size_t(which_)].fetch_add(1, std::memory_order_relaxed);
+        state.stage_nanoseconds[size_t(which_)].fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+            std::memory_order_relaxed);
+    }
+
+private:
+    stage which_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} //namespace detail
+
+inline bool enabled()
+{
+#ifdef FFT_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+inline snapshot take_snapshot()
+{
+    snapshot ret;
+    auto& state = detail::global();
+    for (auto i = 0u; i < ret.counters.size(); ++i)
+        ret.counters[i] = state.counters[i];
+    for (auto i = 0u; i < ret.stages.size(); ++i)
+        ret.stages[i] = {state.stage_calls[i], state.stage_nanoseconds[i]};
+    std::lock_guard<std::mutex> lock(state.sizes_mutex);
+    ret.transforms_by_size = state.transforms_by_size;
+    return ret;
+}
+
+inline void reset()
+{
+    detail::global().reset();
+}
+
+} //namespace instrumentation
+
+#ifdef FFT_INSTRUMENTATION
+#define FFT_INSTRUMENT_CONCAT_IMPL(first, second) first##second
+#define FFT_INSTRUMENT_CONCAT(first, second) FFT_INSTRUMENT_CONCAT_IMPL(first, second)
+#define FFT_INSTRUMENT_COUNT(which, amount) \
+    instrumentation::detail::add(instrumentation::counter::which, amount)
+#define FFT_INSTRUMENT_ALLOCATION(bytes) instrumentation::detail::allocation(bytes)
+#define FFT_INSTRUMENT_TRANSFORM(size) instrumentation::detail::transform(size)
+#define FFT_INSTRUMENT_STAGE(which) \
+    instrumentation::detail::scoped_timer FFT_INSTRUMENT_CONCAT(stage_timer_, __LINE__)( \
+        instrumentation::stage::which)
+#else
+#define FFT_INSTRUMENT_COUNT(which, amount) ((void)0)
+#define FFT_INSTRUMENT_ALLOCATION(bytes) ((void)0)
+#define FFT_INSTRUMENT_TRANSFORM(size) ((void)0)
+#define FFT_INSTRUMENT_STAGE(which) ((void)0)
+#endif
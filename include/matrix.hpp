@@ -1,19 +1,42 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
 #include <stdexcept>
+#include "instrumentation.hpp"
 
 namespace matrix
 {
 
+//side of the square tiles in which the transposes go, so that the strided writes
+//of one tile stay within a few cache lines and pages
+const size_t transpose_tile = 32;
+
+//into an existing buffer of width * height elements
+template <typename T>
+void transpose(const T* arg, size_t width, size_t height, T* ret)
+{
+    FFT_INSTRUMENT_STAGE(transpose);
+    for (auto row_tile = size_t(0); row_tile < height; row_tile += transpose_tile)
+    {
+        auto row_end = std::min(height, row_tile + transpose_tile);
+        for (auto col_tile = size_t(0); col_tile < width; col_tile += transpose_tile)
+        {
+            auto col_end = std::min(width, col_tile + transpose_tile);
+            for (auto row = row_tile; row < row_end; ++row)
+                for (auto col = col_tile; col < col_end; ++col)
+                    ret[col * height + row] = arg[row * width + col];
+        }
+    }
+}
+
 template <typename T>
 std::vector<T> transpose(std::vector<T> arg, size_t width)
 {
+    FFT_INSTRUMENT_ALLOCATION(arg.size() * sizeof(T));
     auto height = arg.size() / width;
     std::vector<T> ret(height * width);
-    for (auto row = 0u; row < height; ++row)
-        for (auto col = 0u; col < width; ++col)
-            ret[col * height + row] = arg[row * width + col];
+    transpose(arg.data(), width, height, ret.data());
     return ret;
 }
 
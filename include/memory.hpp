@@ -0,0 +1,368 @@
+#pragma once
+
+#include <map>
+#include <new>
+#include <atomic>
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <sys/mman.h>
+#include "instrumentation.hpp"
+
+//Cache line aligned allocations and a per thread pool of workspaces, from which
+//the transforms take their scratch buffers so that repeated calls of the same
+//size do not go to the heap. Blocks of 2MB and more are mapped directly and can
+//be backed by huge pages, which cuts the TLB misses of strided passes over them.
+
+namespace memory
+{
+
+const size_t cache_line = 64;
+const size_t huge_page_size = 2u << 20;
+
+//explicit_huge tries MAP_HUGETLB (needs pages reserved in vm.nr_hugepages) and
+//falls back to transparent, which asks for huge pages with madvise; both fall
+//back to normal pages when the kernel refuses
+enum class page_policy
+{
+    normal,
+    transparent,
+    explicit_huge
+};
+
+namespace detail
+{
+
+inline void* allocate_aligned(size_t bytes, size_t alignment)
+{
+    void* ret = nullptr;
+    if (posix_memalign(&ret, alignment, (bytes == 0) ? alignment : bytes) != 0)
+        throw std::bad_alloc();
+    FFT_INSTRUMENT_ALLOCATION(bytes);
+    return ret;
+}
+
+inline void deallocate_aligned(void* block)
+{
+    std::free(block);
+}
+
+inline std::atomic<page_policy>& pool_page_policy()
+{
+    static std::atomic<page_policy> ret(page_policy::normal);
+    return ret;
+}
+
+inline size_t mapped_size(size_t bytes)
+{
+    return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+}
+
+//huge page aligned mapping of mapped_size(bytes)
+inline void* map_pages(size_t bytes, page_policy policy)
+{
+    bytes = mapped_size(bytes);
+    FFT_INSTRUMENT_ALLOCATION(bytes);
+#ifdef MAP_HUGETLB
+    if (policy == page_policy::explicit_huge)
+    {
+        auto ret = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (ret != MAP_FAILED) return ret;
+    }
+#endif
+
+    //over map by a huge page and cut the unaligned ends off
+    auto mapping = mmap(nullptr, bytes + huge_page_size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) throw std::bad_alloc();
+    auto begin = reinterpret_cast<uintptr_t>(mapping);
+    auto aligned = (begin + huge_page_size - 1) / huge_page_size * huge_page_size;
+    if (aligned > begin)
+        munmap(mapping, aligned - begin);
+    if (aligned + bytes < begin + bytes + huge_page_size)
+        munmap(reinterpret_cast<void*>(aligned + bytes), begin + huge_page_size - aligned);
+
+    auto ret = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+    if (policy != page_policy::normal)
+        madvise(ret, bytes, MADV_HUGEPAGE);
+#endif
+    return ret;
+}
+
+inline void unmap_pages(void* block, size_t bytes)
+{
+    munmap(block, mapped_size(bytes));
+}
+
+//workspaces come in power of two sizes, at least one cache line
+inline size_t size_class(size_t bytes)
+{
+    auto ret = cache_line;
+    while (ret < bytes) ret *= 2;
+    return ret;
+}
+
+} //namespace detail
+
+//huge page use of the workspaces of 2MB and more taken from now on
+inline void set_page_policy(page_policy policy)
+{
+    detail::pool_page_policy() = policy;
+}
+
+inline page_policy current_page_policy()
+{
+    return detail::pool_page_policy();
+}
+
+template <typename T, size_t Alignment = cache_line>
+class aligned_allocator
+{
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = aligned_allocator<U, Alignment>;
+    };
+
+    aligned_allocator() {}
+
+    template <typename U>
+    aligned_allocator(const aligned_allocator<U, Alignment>&) {}
+
+    T* allocate(size_t count)
+    {
+        if (count > std::numeric_limits<size_t>::max() / sizeof(T))
+            throw std::bad_alloc();
+        return static_cast<T*>(detail::allocate_aligned(count * sizeof(T), Alignment));
+    }
+
+    void deallocate(T* block, size_t)
+    {
+        detail::deallocate_aligned(block);
+    }
+};
+
+template <typename T, typename U, size_t Alignment>
+bool operator==(const aligned_allocator<T, Alignment>&, const aligned_allocator<U, Alignment>&)
+{
+    return true;
+}
+
+template <typename T, typename U, size_t Alignment>
+bool operator!=(const aligned_allocator<T, Alignment>&, const aligned_allocator<U, Alignment>&)
+{
+    return false;
+}
+
+template <typename T>
+using aligned_vector = std::vector<T, aligned_allocator<T>>;
+
+//Maps allocations of 2MB and more with the given policy, smaller ones are only
+//cache line aligned.
+template <typename T>
+class huge_page_allocator
+{
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = huge_page_allocator<U>;
+    };
+
+    huge_page_allocator(page_policy policy = page_policy::transparent) : policy_(policy) {}
+
+    template <typename U>
+    huge_page_allocator(const huge_page_allocator<U>& other) : policy_(other.policy()) {}
+
+    T* allocate(size_t count)
+    {
+        if (count > std::numeric_limits<size_t>::max() / sizeof(T))
+            throw std::bad_alloc();
+        auto bytes = count * sizeof(T);
+        if (bytes < huge_page_size)
+            return static_cast<T*>(detail::allocate_aligned(bytes, cache_line));
+        return static_cast<T*>(detail::map_pages(bytes, policy_));
+    }
+
+    void deallocate(T* block, size_t count)
+    {
+        auto bytes = count * sizeof(T);
+        if (bytes < huge_page_size)
+            detail::deallocate_aligned(block);
+        else
+            detail::unmap_pages(block, bytes);
+    }
+
+    page_policy policy() const
+    {
+        return policy_;
+    }
+
+private:
+    page_policy policy_;
+};
+
+//the policy only affects new allocations, any instance frees any block
+template <typename T, typename U>
+bool operator==(const huge_page_allocator<T>&, const huge_page_allocator<U>&)
+{
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const huge_page_allocator<T>&, const huge_page_allocator<U>&)
+{
+    return false;
+}
+
+template <typename T>
+using huge_vector = std::vector<T, huge_page_allocator<T>>;
+
+struct pool_statistics
+{
+    uint64_t acquisitions;
+    uint64_t reuses;
+    uint64_t allocations;
+    size_t bytes_reserved;
+    size_t bytes_in_use;
+    size_t peak_bytes_in_use;
+};
+
+//Keeps released blocks by size class and hands them out again; not thread safe,
+//every thread uses its own (thread_pool()).
+class workspace_pool
+{
+public:
+    workspace_pool() : statistics_() {}
+
+    workspace_pool(const workspace_pool&) = delete;
+    workspace_pool& operator=(const workspace_pool&) = delete;
+
+    ~workspace_pool()
+    {
+        trim();
+    }
+
+    //a cache line aligned block of at least bytes, whose actual size is stored in capacity
+    void* acquire(size_t bytes, size_t& capacity)
+    {
+        capacity = detail::size_class(bytes);
+        ++statistics_.acquisitions;
+        statistics_.bytes_in_use += capacity;
+        statistics_.peak_bytes_in_use = std::max(statistics_.peak_bytes_in_use, statistics_.bytes_in_use);
+
+        auto& idle = idle_[capacity];
+        if (not idle.empty())
+        {
+            ++statistics_.reuses;
+            auto ret = idle.back();
+            idle.pop_back();
+            return ret;
+        }
+        ++statistics_.allocations;
+        statistics_.bytes_reserved += capacity;
+        if (capacity >= huge_page_size)
+            return detail::map_pages(capacity, current_page_policy());
+        return detail::allocate_aligned(capacity, cache_line);
+    }
+
+    void release(void* block, size_t capacity)
+    {
+        statistics_.bytes_in_use -= capacity;
+        idle_[capacity].push_back(block);
+    }
+
+    //frees every block which is not in use
+    void trim()
+    {
+        for (auto& entry : idle_)
+        {
+            for (auto block : entry.second)
+                free(block, entry.first);
+            statistics_.bytes_reserved -= entry.first * entry.second.size();
+        }
+        idle_.clear();
+    }
+
+    const pool_statistics& statistics() const
+    {
+        return statistics_;
+    }
+
+private:
+    static void free(void* block, size_t capacity)
+    {
+        if (capacity >= huge_page_size)
+            detail::unmap_pages(block, capacity);
+        else
+            detail::deallocate_aligned(block);
+    }
+
+    std::map<size_t, std::vector<void*>> idle_;
+    pool_statistics statistics_;
+};
+
+inline workspace_pool& thread_pool()
+{
+    static thread_local workspace_pool ret;
+    return ret;
+}
+
+//Scratch buffer of count uninitialized elements borrowed from a pool, given back
+//when destroyed; meant for arithmetic types and std::complex.
+template <typename T>
+class workspace
+{
+public:
+    explicit workspace(size_t count, workspace_pool& pool = thread_pool())
+        : pool_(&pool),
+          size_(count),
+          data_(static_cast<T*>(pool.acquire(count * sizeof(T), capacity_)))
+    {}
+
+    workspace(const workspace&) = delete;
+    workspace& operator=(const workspace&) = delete;
+
+    workspace(workspace&& other)
+        : pool_(other.pool_), size_(other.size_), capacity_(other.capacity_), data_(other.data_)
+    {
+        other.data_ = nullptr;
+    }
+
+    ~workspace()
+    {
+        if (data_ != nullptr) pool_->release(data_, capacity_);
+    }
+
+    T* data() const
+    {
+        return data_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    T& operator[](size_t index) const
+    {
+        return data_[index];
+    }
+
+private:
+    workspace_pool* pool_;
+    size_t size_;
+    size_t capacity_;
+    T* data_;
+};
+
+} //namespace memory
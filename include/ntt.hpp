@@ -0,0 +1,281 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include "fft.hpp"
+#include "convolution.hpp"
+
+namespace ntt
+{
+
+//NTT friendly prime: modulus = c * 2^k + 1 with primitive root generator
+struct prime
+{
+    uint32_t modulus;
+    uint32_t generator;
+};
+
+const prime default_prime = {998244353u, 3u};
+//their product is above 2^85, enough for exact products of 64 bit sequences
+const prime crt_primes[] = {{167772161u, 3u}, {469762049u, 3u}, {754974721u, 11u}};
+
+//Arithmetic in Montgomery form (value * 2^32 mod modulus) for odd moduli below 2^30,
+//which keeps every multiplication free of divisions.
+class montgomery
+{
+public:
+    explicit montgomery(uint32_t modulus)
+        : modulus_(modulus),
+          inverse_(negated_inverse(modulus)),
+          r2_(uint32_t((~uint64_t(0) % modulus + 1) % modulus))
+    {
+        if ((modulus % 2 == 0) or (modulus >= (1u << 30)))
+            throw std::runtime_error("modulus has to be odd and below 2^30");
+    }
+
+    uint32_t modulus() const
+    {
+        return modulus_;
+    }
+
+    uint32_t to(uint32_t value) const
+    {
+        return reduce(uint64_t(value % modulus_) * r2_);
+    }
+
+    uint32_t from(uint32_t value) const
+    {
+        return reduce(value);
+    }
+
+    uint32_t multiply(uint32_t first, uint32_t second) const
+    {
+        return reduce(uint64_t(first) * second);
+    }
+
+    uint32_t add(uint32_t first, uint32_t second) const
+    {
+        auto ret = first + second;
+        return (ret >= modulus_) ? ret - modulus_ : ret;
+    }
+
+    uint32_t subtract(uint32_t first, uint32_t second) const
+    {
+        return (first >= second) ? first - second : first + modulus_ - second;
+    }
+
+    uint32_t power(uint32_t base, uint64_t exponent) const
+    {
+        auto ret = to(1);
+        for (; exponent > 0; exponent >>= 1)
+        {
+            if (exponent & 1) ret = multiply(ret, base);
+            base = multiply(base, base);
+        }
+        return ret;
+    }
+
+private:
+    static uint32_t negated_inverse(uint32_t modulus)
+    {
+        //Newton iteration, every step doubles the number of correct low bits
+        auto inverse = modulus;
+        for (auto i = 0; i < 4; ++i)
+            inverse *= 2 - modulus * inverse;
+        return 0u - inverse;
+    }
+
+    uint32_t reduce(uint64_t value) const
+    {
+        auto factor = uint32_t(value) * inverse_;
+        auto ret = uint32_t((value + uint64_t(factor) * modulus_) >> 32);
+        return (ret >= modulus_) ? ret - modulus_ : ret;
+    }
+
+    uint32_t modulus_;
+    uint32_t inverse_;
+    uint32_t r2_;
+};
+
+//Number theoretic transform of one power of two size, sharing the bit reversal
+//permutation and the radix-2 passes with fft::plan. Works on values in Montgomery form.
+class plan
+{
+public:
+    plan(size_t size, prime field = default_prime)
+        : size_(size),
+          arithmetic_(field.modulus),
+          permutation_(fft::impl::bit_reversal_table(size)),
+          roots_(size / 2),
+          inverse_roots_(size / 2)
+    {
+        if (not fft::impl::is_power_of_2(size))
+            throw std::runtime_error("ntt size has to be a power of two");
+        if ((field.modulus - 1) % size != 0)
+            throw std::runtime_error("ntt size is too big for the modulus");
+
+        FFT_INSTRUMENT_COUNT(plans_created, 1);
+        FFT_INSTRUMENT_COUNT(twiddle_tables_computed, 1);
+        FFT_INSTRUMENT_ALLOCATION(size * sizeof(uint32_t));
+
+        auto root = arithmetic_.power(arithmetic_.to(field.generator), (field.modulus - 1) / size);
+        auto inverse_root = arithmetic_.power(root, field.modulus - 2);
+        auto current = arithmetic_.to(1);
+        auto inverse_current = current;
+        for (auto k = 0u; k < roots_.size(); ++k)
+        {
+            roots_[k] = current;
+            inverse_roots_[k] = inverse_current;
+            current = arithmetic_.multiply(current, root);
+            inverse_current = arithmetic_.multiply(inverse_current, inverse_root);
+        }
+        size_inverse_ = arithmetic_.power(arithmetic_.to(uint32_t(size % field.modulus)),
+                                          field.modulus - 2);
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    const montgomery& arithmetic() const
+    {
+        return arithmetic_;
+    }
+
+    //in place; the inverse transform is scaled by 1 / size
+    void execute(uint32_t* data, bool is_inverse) const
+    {
+        auto& arithmetic = arithmetic_;
+        auto& roots = is_inverse ? inverse_roots_ : roots_;
+        FFT_INSTRUMENT_TRANSFORM(size_);
+        {
+            FFT_INSTRUMENT_STAGE(permutation);
+            fft::impl::bit_reverse_permute(data, permutation_);
+        }
+        {
+            FFT_INSTRUMENT_STAGE(butterflies);
+            fft::impl::radix2_passes(data, size_, [&](uint32_t& a, uint32_t& b, size_t root) {
+                auto t = arithmetic.multiply(b, roots[root]);
+                b = arithmetic.subtract(a, t);
+                a = arithmetic.add(a, t);
+            });
+        }
+        if (not is_inverse) return;
+        FFT_INSTRUMENT_STAGE(scaling);
+        for (auto i = 0u; i < size_; ++i)
+            data[i] = arithmetic.multiply(data[i], size_inverse_);
+    }
+
+private:
+    size_t size_;
+    montgomery arithmetic_;
+    memory::huge_vector<size_t> permutation_;
+    std::vector<uint32_t> roots_;
+    std::vector<uint32_t> inverse_roots_;
+    uint32_t size_inverse_;
+};
+
+//linear convolution of sequences of residues, with every output reduced modulo the prime
+inline std::vector<uint32_t> convolve(const std::vector<uint32_t>& first,
+                                      const std::vector<uint32_t>& second,
+                                      prime field = default_prime)
+{
+    if (first.empty() or second.empty()) return {};
+
+    auto output_size = first.size() + second.size() - 1;
+    plan transform(convolution::detail::nearest_power_of_2(output_size), field);
+    auto& arithmetic = transform.arithmetic();
+
+    std::vector<uint32_t> freq_first(transform.size(), 0);
+    std::vector<uint32_t> freq_second(transform.size(), 0);
+    for (auto i = 0u; i < first.size(); ++i)
+        freq_first[i] = arithmetic.to(first[i]);
+    for (auto i = 0u; i < second.size(); ++i)
+        freq_second[i] = arithmetic.to(second[i]);
+
+    transform.execute(freq_first.data(), false);
+    transform.execute(freq_second.data(), false);
+    for (auto i = 0u; i < transform.size(); ++i)
+        freq_first[i] = arithmetic.multiply(freq_first[i], freq_second[i]);
+    transform.execute(freq_first.data(), true);
+
+    freq_first.resize(output_size);
+    for (auto& value : freq_first)
+        value = arithmetic.from(value);
+    return freq_first;
+}
+
+namespace detail
+{
+
+inline std::vector<uint32_t> residues(const std::vector<int64_t>& values, uint32_t modulus)
+{
+    std::vector<uint32_t> ret(values.size());
+    for (auto i = 0u; i < values.size(); ++i)
+    {
+        auto residue = values[i] % int64_t(modulus);
+        ret[i] = uint32_t((residue < 0) ? residue + modulus : residue);
+    }
+    return ret;
+}
+
+inline uint64_t inverse_mod(uint64_t value, uint32_t modulus)
+{
+    montgomery arithmetic(modulus);
+    return arithmetic.from(arithmetic.power(arithmetic.to(uint32_t(value % modulus)), modulus - 2));
+}
+
+inline uint64_t max_magnitude(const std::vector<int64_t>& values)
+{
+    uint64_t ret = 0;
+    for (auto value : values)
+        ret = std::max(ret, (value < 0) ? 0 - uint64_t(value) : uint64_t(value));
+    return ret;
+}
+
+} //namespace detail
+
+//Exact linear convolution of integer sequences: one NTT convolution per prime
+//of crt_primes and Chinese remainder reconstruction of the (signed) result.
+//Throws std::overflow_error when the outputs could exceed the int64_t range.
+inline std::vector<int64_t> convolve_exact(const std::vector<int64_t>& first,
+                                           const std::vector<int64_t>& second)
+{
+    if (first.empty() or second.empty()) return {};
+
+    auto bound = (long double)(detail::max_magnitude(first))
+               * (long double)(detail::max_magnitude(second))
+               * (long double)(std::min(first.size(), second.size()));
+    if (bound >= std::ldexp(1.0L, 63))
+        throw std::overflow_error("exact convolution does not fit into 64 bits");
+
+    std::vector<std::vector<uint32_t>> remainders;
+    for (auto& field : crt_primes)
+        remainders.push_back(convolve(detail::residues(first, field.modulus),
+                                      detail::residues(second, field.modulus), field));
+
+    //Garner's algorithm
+    uint64_t m1 = crt_primes[0].modulus;
+    uint64_t m2 = crt_primes[1].modulus;
+    uint64_t m3 = crt_primes[2].modulus;
+    auto m1_inverse = detail::inverse_mod(m1, m2);
+    auto m12_inverse = detail::inverse_mod(m1 * m2 % m3, m3);
+    unsigned __int128 product = (unsigned __int128)(m1 * m2) * m3;
+
+    std::vector<int64_t> ret(remainders[0].size());
+    for (auto i = 0u; i < ret.size(); ++i)
+    {
+        uint64_t r1 = remainders[0][i], r2 = remainders[1][i], r3 = remainders[2][i];
+        auto x12 = r1 + m1 * ((r2 + m2 - r1 % m2) % m2 * m1_inverse % m2);
+        auto digit = (r3 + m3 - x12 % m3) % m3 * m12_inverse % m3;
+        auto value = x12 + (unsigned __int128)(m1 * m2) * digit;
+        ret[i] = (value > product / 2) ? -int64_t(product - value) : int64_t(value);
+    }
+    return ret;
+}
+
+} //namespace ntt
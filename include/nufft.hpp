@@ -0,0 +1,532 @@
+#pragma once
+
+#include <cmath>
+#include <mutex>
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include <stdexcept>
+#include "fft.hpp"
+#include "memory.hpp"
+#include "parallel.hpp"
+
+//Non-uniform fast Fourier transforms between points x_j (radians, any real value,
+//taken modulo 2 pi) and the integer modes -N / 2 <= k < (N + 1) / 2, stored in
+//increasing order:
+//  type 1: f_k = sum_j c_j exp(sign i k x_j)  (non-uniform to uniform),
+//  type 2: c_j = sum_k f_k exp(sign i k x_j)  (uniform to non-uniform).
+//Type 1 spreads the strengths onto a grid oversampled twice (and rounded up to a
+//power of two) with the exponential of semicircle kernel
+//phi(z) = exp(beta (sqrt(1 - z^2) - 1)), transforms the grid and divides every
+//mode by the Fourier transform of the kernel; type 2 runs the same steps backwards,
+//interpolating the grid at the points. The kernel width follows the tolerance.
+
+namespace nufft
+{
+
+namespace detail
+{
+
+//w points of support and beta for a relative error of about tolerance at an oversampling of 2
+class kernel
+{
+public:
+    explicit kernel(double tolerance)
+    {
+        if (not (tolerance > 0.0) or (tolerance >= 1.0))
+            throw std::runtime_error("nufft tolerance has to be between 0 and 1");
+        width_ = std::min<size_t>(16, std::max<size_t>(2, size_t(std::ceil(-std::log10(tolerance))) + 1));
+        beta_ = 2.30L * width_;
+    }
+
+    size_t width() const
+    {
+        return width_;
+    }
+
+    //grid offset of the low values of arrays padded for the kernel
+    size_t pad() const
+    {
+        return width_ / 2 + 1;
+    }
+
+    //first of the width() grid points the point at grid coordinate t reaches
+    long first(long double t) const
+    {
+        return long(std::ceil(t - width_ / 2.0L));
+    }
+
+    template <typename T>
+    void evaluate(T t, long first, T* values) const
+    {
+        auto half = T(width_) / 2;
+        auto beta = T(beta_);
+        for (auto i = size_t(0); i < width_; ++i)
+        {
+            auto z = (T(first + long(i)) - t) / half;
+            values[i] = std::exp(beta * (std::sqrt(std::max(T(0), 1 - z * z)) - 1));
+        }
+    }
+
+    //sum over the grid of phi((l - t) / (w / 2)) exp(i a (l - t)) for a grid frequency a,
+    //i.e. the Fourier transform (w / 2) int phi(z) exp(i a w z / 2) dz, by Gauss-Legendre quadrature
+    long double transform(long double frequency) const
+    {
+        static thread_local std::vector<long double> nodes, weights;
+        auto count = 2 * width_ + 8;
+        if (nodes.size() != count) gauss_legendre(count, nodes, weights);
+        auto ret = 0.0L;
+        for (auto i = size_t(0); i < count; ++i)
+        {
+            auto z = nodes[i];
+            auto phi = std::exp(beta_ * (std::sqrt(1 - z * z) - 1));
+            ret += weights[i] * phi * std::cos(frequency * width_ * z / 2);
+        }
+        return ret * width_ / 2;
+    }
+
+private:
+    //nodes and weights on [-1, 1] from Newton iterations on the Legendre polynomial
+    static void gauss_legendre(size_t count, std::vector<long double>& nodes, std::vector<long double>& weights)
+    {
+        static const long double pi = 3.141592653589793238462643383279502884L;
+        nodes.assign(count, 0.0L);
+        weights.assign(count, 0.0L);
+        for (auto i = size_t(0); i < count; ++i)
+        {
+            auto x = std::cos(pi * (i + 0.75L) / (count + 0.5L));
+            auto derivative = 0.0L;
+            for (auto iteration = 0; iteration < 100; ++iteration)
+            {
+                auto p0 = 1.0L, p1 = x;
+                for (auto n = size_t(2); n <= count; ++n)
+                {
+                    auto p2 = ((2 * n - 1) * x * p1 - (n - 1) * p0) / n;
+                    p0 = p1;
+                    p1 = p2;
+                }
+                derivative = count * (x * p1 - p0) / (x * x - 1);
+                auto step = p1 / derivative;
+                x -= step;
+                if (std::abs(step) < 1.0e-19L) break;
+            }
+            nodes[i] = x;
+            weights[i] = 2 / ((1 - x * x) * derivative * derivative);
+        }
+    }
+
+    size_t width_;
+    long double beta_;
+};
+
+inline size_t grid_size(size_t modes, const kernel& spreader)
+{
+    auto ret = size_t(2);
+    while (ret < std::max(2 * modes, 2 * spreader.width())) ret *= 2;
+    return ret;
+}
+
+//grid coordinate of a point in [0, size)
+template <typename T>
+T grid_coordinate(T x, size_t size)
+{
+    static const long double two_pi = 6.283185307179586476925286766559005768L;
+    auto ret = std::fmod((long double)(x), two_pi) / two_pi * size;
+    if (ret < 0) ret += size;
+    if (ret >= size) ret -= size;
+    //rounding to T may reach size
+    return (T(ret) < T(size)) ? T(ret) : T(0);
+}
+
+//1 / (transform of the kernel) for every mode, times scale
+template <typename T>
+std::vector<T> corrections(size_t modes, size_t grid, const kernel& spreader, long double scale)
+{
+    static const long double two_pi = 6.283185307179586476925286766559005768L;
+    std::vector<T> ret(modes);
+    for (auto i = size_t(0); i < modes; ++i)
+    {
+        auto k = (long double)(long(i) - long(modes / 2));
+        ret[i] = T(scale / spreader.transform(two_pi * k / grid));
+    }
+    return ret;
+}
+
+//grid index of the mode stored at index i
+inline size_t mode_bin(size_t i, size_t modes, size_t grid)
+{
+    return size_t((long(i) - long(modes / 2) + long(grid)) % long(grid));
+}
+
+//point indices ordered by the cells of 16 x 16 grid points they fall in, rows of cells first
+template <typename T>
+std::vector<size_t> sort_points(const std::vector<T>& x, const std::vector<T>& y, size_t columns)
+{
+    std::vector<size_t> key(x.size()), ret(x.size());
+    auto cells_per_row = columns / 16 + 1;
+    for (auto j = size_t(0); j < x.size(); ++j)
+    {
+        auto row = y.empty() ? size_t(0) : size_t(y[j]) / 16;
+        key[j] = row * cells_per_row + size_t(x[j]) / 16;
+        ret[j] = j;
+    }
+    std::sort(ret.begin(), ret.end(), [&key](size_t a, size_t b) { return key[a] < key[b]; });
+    return ret;
+}
+
+//a kernel wide margin on both sides of every dimension
+template <typename T>
+struct padded_grid
+{
+    padded_grid(const std::complex<T>* grid, size_t width, size_t height, size_t pad, size_t margin, bool vertical)
+        : columns(width + margin), values((vertical ? height + margin : height) * (width + margin))
+    {
+        auto row_pad = vertical ? pad : 0;
+        auto rows = values.size() / columns;
+        auto wrap = [](long index, size_t size) { return size_t((index % long(size) + long(size)) % long(size)); };
+        for (auto row = size_t(0); row < rows; ++row)
+        {
+            auto source = grid + wrap(long(row) - long(row_pad), height) * width;
+            for (auto col = size_t(0); col < columns; ++col)
+                values[row * columns + col] = source[wrap(long(col) - long(pad), width)];
+        }
+    }
+
+    size_t columns;
+    std::vector<std::complex<T>> values;
+};
+
+//Transforms with 2D modes (width modes along x, contiguous, height along y) of
+//which the 1D ones are the case height = 1 without y coordinates. Spreading and
+//interpolation split the points, sorted by grid cell, between threads; every
+//thread spreads into its own patch of the grid, which are added up afterwards.
+template <typename T>
+class gridder
+{
+public:
+    gridder(size_t width, size_t height, double tolerance, size_t threads, bool one_dimensional)
+        : width_(width),
+          height_(height),
+          one_dimensional_(one_dimensional),
+          threads_(std::max<size_t>(threads, 1)),
+          kernel_(tolerance),
+          grid_width_(grid_size(width, kernel_)),
+          grid_height_(one_dimensional ? 1 : grid_size(height, kernel_))
+    {
+        if ((width == 0) or (height == 0))
+            throw std::runtime_error("nufft needs at least one mode");
+        correction_x_ = corrections<T>(width_, grid_width_, kernel_, 1.0L);
+        correction_y_ = one_dimensional ? std::vector<T>(1, T(1)) : corrections<T>(height_, grid_height_, kernel_, 1.0L);
+    }
+
+    size_t modes() const
+    {
+        return width_ * height_;
+    }
+
+    //sizes of the oversampled grid
+    size_t grid_width() const
+    {
+        return grid_width_;
+    }
+
+    size_t grid_height() const
+    {
+        return grid_height_;
+    }
+
+    size_t kernel_width() const
+    {
+        return kernel_.width();
+    }
+
+    fft::ComplexVec<T> type1(const std::vector<T>& x, const std::vector<T>& y,
+                             const fft::ComplexVec<T>& strengths, int sign) const
+    {
+        check_points(x, y, strengths.size());
+        auto tx = coordinates(x, grid_width_), ty = coordinates(y, grid_height_);
+        auto order = sort_points(tx, ty, grid_width_);
+
+        memory::workspace<std::complex<T>> grid(grid_width_ * grid_height_);
+        std::fill(grid.data(), grid.data() + grid.size(), std::complex<T>());
+        spread(tx, ty, strengths, order, grid.data());
+        transform(grid.data(), sign);
+
+        fft::ComplexVec<T> ret(modes());
+        for (auto row = size_t(0); row < height_; ++row)
+        {
+            auto source = grid.data() + mode_bin(row, height_, grid_height_) * grid_width_;
+            for (auto col = size_t(0); col < width_; ++col)
+                ret[row * width_ + col] = source[mode_bin(col, width_, grid_width_)]
+                                          * (correction_x_[col] * correction_y_[row]);
+        }
+        return ret;
+    }
+
+    fft::ComplexVec<T> type2(const std::vector<T>& x, const std::vector<T>& y,
+                             const fft::ComplexVec<T>& modes, int sign) const
+    {
+        check_points(x, y, x.size());
+        if (modes.size() != this->modes())
+            throw std::runtime_error("nufft modes differ from the plan");
+
+        memory::workspace<std::complex<T>> grid(grid_width_ * grid_height_);
+        std::fill(grid.data(), grid.data() + grid.size(), std::complex<T>());
+        for (auto row = size_t(0); row < height_; ++row)
+        {
+            auto target = grid.data() + mode_bin(row, height_, grid_height_) * grid_width_;
+            for (auto col = size_t(0); col < width_; ++col)
+                target[mode_bin(col, width_, grid_width_)] =
+                    modes[row * width_ + col] * (correction_x_[col] * correction_y_[row]);
+        }
+        transform(grid.data(), sign);
+
+        auto tx = coordinates(x, grid_width_), ty = coordinates(y, grid_height_);
+        auto order = sort_points(tx, ty, grid_width_);
+        return interpolate(tx, ty, order, grid.data());
+    }
+
+private:
+    void check_points(const std::vector<T>& x, const std::vector<T>& y, size_t count) const
+    {
+        if ((x.size() != count) or (y.size() != (one_dimensional_ ? 0 : count)))
+            throw std::runtime_error("nufft needs one coordinate per dimension for every point");
+    }
+
+    std::vector<T> coordinates(const std::vector<T>& values, size_t grid) const
+    {
+        std::vector<T> ret(values.size());
+        for (auto j = size_t(0); j < values.size(); ++j)
+            ret[j] = grid_coordinate(values[j], grid);
+        return ret;
+    }
+
+    void transform(std::complex<T>* grid, int sign) const
+    {
+        auto is_inverse = (sign > 0);
+        if (one_dimensional_)
+            is_inverse ? fft::inv_fft_in_place(grid, grid_width_) : fft::fft_in_place(grid, grid_width_);
+        else if (is_inverse)
+            fft::inv_fft_2d_in_place(grid, grid_width_, grid_height_);
+        else
+            fft::fft_2d_in_place(grid, grid_width_, grid_height_);
+        if (not is_inverse) return;
+        //the sums with sign +1 are the inverse transforms times the grid size
+
+        auto size = grid_width_ * grid_height_;
+        for (auto i = size_t(0); i < size; ++i)
+            grid[i] *= T(size);
+    }
+
+    //Every thread spreads its points into rows [first_row, first_row + rows) of a
+    //grid with pad columns of margin on each side, then adds them to the grid.
+    void spread(const std::vector<T>& tx, const std::vector<T>& ty, const fft::ComplexVec<T>& strengths,
+                const std::vector<size_t>& order, std::complex<T>* grid) const
+    {
+        auto width = kernel_.width(), pad = kernel_.pad();
+        auto columns = grid_width_ + width + 2;
+        std::mutex merge;
+        parallel::for_ranges(order.size(), threads_, [&](size_t begin, size_t end) {
+            auto low = kernel_.first(one_dimensional_ ? 0.0L : ty[order[begin]]), high = low;
+            for (auto i = begin; (i < end) and not one_dimensional_; ++i)
+            {
+                low = std::min(low, kernel_.first(ty[order[i]]));
+                high = std::max(high, kernel_.first(ty[order[i]]));
+            }
+            auto rows = one_dimensional_ ? size_t(1) : size_t(high - low) + width;
+            std::vector<T> patch(2 * rows * columns, T(0));
+            T kx[16], ky[16] = {T(1)};
+            for (auto i = begin; i < end; ++i)
+            {
+                auto j = order[i];
+                auto x0 = kernel_.first(tx[j]);
+                kernel_.evaluate(tx[j], x0, kx);
+                auto y0 = low;
+                if (not one_dimensional_)
+                {
+                    y0 = kernel_.first(ty[j]);
+                    kernel_.evaluate(ty[j], y0, ky);
+                }
+                for (auto dy = size_t(0); dy < (one_dimensional_ ? 1 : width); ++dy)
+                {
+                    auto re = strengths[j].real() * ky[dy], im = strengths[j].imag() * ky[dy];
+                    auto target = patch.data() + 2 * ((size_t(y0 - low) + dy) * columns + size_t(x0 + long(pad)));
+                    for (auto dx = size_t(0); dx < width; ++dx)
+                    {
+                        target[2 * dx] += re * kx[dx];
+                        target[2 * dx + 1] += im * kx[dx];
+                    }
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(merge);
+            for (auto row = size_t(0); row < rows; ++row)
+            {
+                auto global = size_t((long(row) + low) % long(grid_height_) + long(grid_height_)) % grid_height_;
+                auto line = grid + global * grid_width_;
+                auto source = patch.data() + 2 * row * columns;
+                for (auto col = size_t(0); col < columns; ++col)
+                {
+                    auto x = (col + grid_width_ - pad) % grid_width_;
+                    line[x] += std::complex<T>(source[2 * col], source[2 * col + 1]);
+                }
+            }
+        });
+    }
+
+    fft::ComplexVec<T> interpolate(const std::vector<T>& tx, const std::vector<T>& ty,
+                                   const std::vector<size_t>& order, const std::complex<T>* grid) const
+    {
+        auto width = kernel_.width(), pad = kernel_.pad();
+        padded_grid<T> padded(grid, grid_width_, grid_height_, pad, width + 2, not one_dimensional_);
+        fft::ComplexVec<T> ret(order.size());
+        parallel::for_ranges(order.size(), threads_, [&](size_t begin, size_t end) {
+            T kx[16], ky[16] = {T(1)};
+            for (auto i = begin; i < end; ++i)
+            {
+                auto j = order[i];
+                auto x0 = kernel_.first(tx[j]);
+                kernel_.evaluate(tx[j], x0, kx);
+                auto row = size_t(0);
+                if (not one_dimensional_)
+                {
+                    auto y0 = kernel_.first(ty[j]);
+                    kernel_.evaluate(ty[j], y0, ky);
+                    row = size_t(y0 + long(pad));
+                }
+                auto re = T(0), im = T(0);
+                for (auto dy = size_t(0); dy < (one_dimensional_ ? 1 : width); ++dy)
+                {
+                    auto source = reinterpret_cast<const T*>(
+                        padded.values.data() + (row + dy) * padded.columns + size_t(x0 + long(pad)));
+                    auto line_re = T(0), line_im = T(0);
+                    for (auto dx = size_t(0); dx < width; ++dx)
+                    {
+                        line_re += source[2 * dx] * kx[dx];
+                        line_im += source[2 * dx + 1] * kx[dx];
+                    }
+                    re += line_re * ky[dy];
+                    im += line_im * ky[dy];
+                }
+                ret[j] = std::complex<T>(re, im);
+            }
+        });
+        return ret;
+    }
+
+    size_t width_;
+    size_t height_;
+    bool one_dimensional_;
+    size_t threads_;
+    kernel kernel_;
+    size_t grid_width_;
+    size_t grid_height_;
+    std::vector<T> correction_x_;
+    std::vector<T> correction_y_;
+};
+
+} //namespace detail
+
+//1D transforms of modes integer frequencies
+template <typename T>
+class plan_1d
+{
+public:
+    explicit plan_1d(size_t modes, double tolerance = 1.0e-6, size_t threads = 1)
+        : gridder_(modes, 1, tolerance, threads, true)
+    {}
+
+    size_t modes() const
+    {
+        return gridder_.modes();
+    }
+
+    size_t grid_size() const
+    {
+        return gridder_.grid_width();
+    }
+
+    size_t kernel_width() const
+    {
+        return gridder_.kernel_width();
+    }
+
+    //f_k = sum_j c_j exp(sign i k x_j)
+    fft::ComplexVec<T> type1(const std::vector<T>& x, const fft::ComplexVec<T>& strengths, int sign = -1) const
+    {
+        return gridder_.type1(x, std::vector<T>(), strengths, sign);
+    }
+
+    //c_j = sum_k f_k exp(sign i k x_j)
+    fft::ComplexVec<T> type2(const std::vector<T>& x, const fft::ComplexVec<T>& modes, int sign = 1) const
+    {
+        return gridder_.type2(x, std::vector<T>(), modes, sign);
+    }
+
+private:
+    detail::gridder<T> gridder_;
+};
+
+//2D transforms of width x height integer frequencies, rows of constant k_y
+template <typename T>
+class plan_2d
+{
+public:
+    plan_2d(size_t width, size_t height, double tolerance = 1.0e-6, size_t threads = 1)
+        : gridder_(width, height, tolerance, threads, false)
+    {}
+
+    size_t modes() const
+    {
+        return gridder_.modes();
+    }
+
+    size_t grid_width() const
+    {
+        return gridder_.grid_width();
+    }
+
+    size_t grid_height() const
+    {
+        return gridder_.grid_height();
+    }
+
+    size_t kernel_width() const
+    {
+        return gridder_.kernel_width();
+    }
+
+    //f_(k_x, k_y) = sum_j c_j exp(sign i (k_x x_j + k_y y_j))
+    fft::ComplexVec<T> type1(const std::vector<T>& x, const std::vector<T>& y,
+                             const fft::ComplexVec<T>& strengths, int sign = -1) const
+    {
+        return gridder_.type1(x, y, strengths, sign);
+    }
+
+    //c_j = sum_k f_(k_x, k_y) exp(sign i (k_x x_j + k_y y_j))
+    fft::ComplexVec<T> type2(const std::vector<T>& x, const std::vector<T>& y,
+                             const fft::ComplexVec<T>& modes, int sign = 1) const
+    {
+        return gridder_.type2(x, y, modes, sign);
+    }
+
+private:
+    detail::gridder<T> gridder_;
+};
+
+//modes values of the 1D type 1 transform with sign -1
+template <typename T>
+fft::ComplexVec<T> type1(const std::vector<T>& x, const fft::ComplexVec<T>& strengths, size_t modes,
+                         double tolerance = 1.0e-6)
+{
+    return plan_1d<T>(modes, tolerance).type1(x, strengths);
+}
+
+//the 1D type 2 transform with sign +1 of modes at the points x
+template <typename T>
+fft::ComplexVec<T> type2(const std::vector<T>& x, const fft::ComplexVec<T>& modes, double tolerance = 1.0e-6)
+{
+    return plan_1d<T>(modes.size(), tolerance).type2(x, modes);
+}
+
+} //namespace nufft
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <memory>
+#include <complex>
+#include <cstdint>
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "fft.hpp"
+#include "memory.hpp"
+
+//Transforms of raw files of interleaved std::complex<T> values that need not fit
+//into memory, with the four step decomposition of N = rows * columns: the file is
+//viewed as a row major rows x columns matrix, every column is transformed and
+//multiplied by the twiddles, then every row is transformed and written out transposed.
+
+namespace out_of_core
+{
+
+struct report
+{
+    size_t size;
+    size_t rows;
+    size_t columns;
+    //sweeps reading and writing the whole data set once each
+    size_t passes;
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+};
+
+namespace detail
+{
+
+class file
+{
+public:
+    file(const std::string& path, int flags)
+        : path_(path), descriptor_(::open(path.c_str(), flags, 0644))
+    {
+        if (descriptor_ < 0)
+            throw std::runtime_error("cannot open " + path);
+    }
+
+    file(const file&) = delete;
+    file& operator=(const file&) = delete;
+
+    ~file()
+    {
+        ::close(descriptor_);
+    }
+
+    uint64_t size() const
+    {
+        struct stat status;
+        if (::fstat(descriptor_, &status) != 0)
+            throw std::runtime_error("cannot stat " + path_);
+        return uint64_t(status.st_size);
+    }
+
+    void resize(uint64_t bytes)
+    {
+        if (::ftruncate(descriptor_, off_t(bytes)) != 0)
+            throw std::runtime_error("cannot resize " + path_);
+    }
+
+    void read(uint64_t offset, void* data, size_t bytes)
+    {
+        auto target = static_cast<char*>(data);
+        while (bytes > 0)
+        {
+            auto done = ::pread(descriptor_, target, bytes, off_t(offset));
+            if (done <= 0)
+                throw std::runtime_error("cannot read " + path_);
+            target += done;
+            offset += done;
+            bytes -= done;
+        }
+    }
+
+    void write(uint64_t offset, const void* data, size_t bytes)
+    {
+        auto source = static_cast<const char*>(data);
+        while (bytes > 0)
+        {
+            auto done = ::pwrite(descriptor_, source, bytes, off_t(offset));
+            if (done <= 0)
+                throw std::runtime_error("cannot write " + path_);
+            source += done;
+            offset += done;
+            bytes -= done;
+        }
+    }
+
+private:
+    std::string path_;
+    int descriptor_;
+};
+
+//exp(-+2 pi i m / size) for any m as the product of a fine and a coarse table
+//entry, which needs 2 sqrt(size) values instead of size
+template <typename T>
+class twiddles
+{
+public:
+    twiddles(size_t size, bool is_inverse) : size_(size), fine_size_(1)
+    {
+        while (fine_size_ * fine_size_ < size) fine_size_ *= 2;
+        static const long double pi = 3.141592653589793238462643383279502884L;
+        auto sign = is_inverse ? 1.0L : -1.0L;
+        for (auto j = size_t(0); j < fine_size_; ++j)
+            fine_.push_back(root(sign * 2 * pi * (long double)(j) / (long double)(size)));
+        for (auto j = size_t(0); j < size / fine_size_; ++j)
+            coarse_.push_back(root(sign * 2 * pi * (long double)(j * fine_size_) / (long double)(size)));
+    }
+
+    std::complex<T> operator()(uint64_t m) const
+    {
+        m %= size_;
+        return fine_[m % fine_size_] * coarse_[m / fine_size_];
+    }
+
+private:
+    static std::complex<T> root(long double angle)
+    {
+        return std::complex<T>(T(std::cos(angle)), T(std::sin(angle)));
+    }
+
+    size_t size_;
+    size_t fine_size_;
+    std::vector<std::complex<T>> fine_;
+    std::vector<std::complex<T>> coarse_;
+};
+
+//removes the file when leaving the scope, also when an exception does
+class removed_on_exit
+{
+public:
+    explicit removed_on_exit(const std::string& path) : path_(path) {}
+
+    removed_on_exit(const removed_on_exit&) = delete;
+    removed_on_exit& operator=(const removed_on_exit&) = delete;
+
+    ~removed_on_exit()
+    {
+        std::remove(path_.c_str());
+    }
+
+private:
+    std::string path_;
+};
+
+inline size_t power_of_2_below(size_t value)
+{
+    auto ret = size_t(1);
+    while (2 * ret <= value) ret *= 2;
+    return ret;
+}
+
+template <typename T>
+report transform(const std::string& input_path, const std::string& output_path,
+                 size_t memory_budget, bool is_inverse)
+{
+    using element = std::complex<T>;
+    file input(input_path, O_RDONLY);
+    if (input.size() % sizeof(element) != 0)
+        throw std::runtime_error("input is not a whole number of complex values: " + input_path);
+    report ret = {size_t(input.size() / sizeof(element)), 1, 1, 0, 0, 0};
+    auto size = ret.size;
+    auto budget = memory_budget / sizeof(element);
+    if (not fft::impl::is_power_of_2(size))
+        throw std::runtime_error("fft size has to be a power of two");
+
+    if (size <= budget)
+    {
+        std::vector<element> data(size);
+        input.read(0, data.data(), size * sizeof(element));
+        std::shared_ptr<const fft::plan<T>> held;
+        fft::impl::plan_for<T>(size, held).execute(data.data(), is_inverse);
+        file output(output_path, O_RDWR | O_CREAT | O_TRUNC);
+        output.write(0, data.data(), size * sizeof(element));
+        ret.rows = size;
+        ret.passes = 1;
+        ret.bytes_read = ret.bytes_written = size * sizeof(element);
+        return ret;
+    }
+
+    //columns of length rows / rows of length columns, balanced
+    auto& rows = ret.rows;
+    auto& columns = ret.columns;
+    rows = 1;
+    while (rows * rows < size) rows *= 2;
+    columns = size / rows;
+    if (rows > budget)
+        throw std::runtime_error("memory budget is too small for an out of core fft of this size");
+
+    auto temporary_path = output_path + ".partial";
+    removed_on_exit temporary_cleanup(temporary_path);
+    std::shared_ptr<const fft::plan<T>> held_rows, held_columns;
+    auto& column_transform = fft::impl::plan_for<T>(rows, held_columns);
+    auto& row_transform = fft::impl::plan_for<T>(columns, held_rows);
+
+    //pass 1: blocks of whole columns, read and written as one segment per row
+    {
+        file temporary(temporary_path, O_RDWR | O_CREAT | O_TRUNC);
+        temporary.resize(size * sizeof(element));
+        twiddles<T> factors(size, is_inverse);
+        auto block = std::min(columns, power_of_2_below(budget / rows));
+        memory::workspace<element> data(block * rows);
+        std::vector<element> segment(block);
+        for (auto first = size_t(0); first < columns; first += block)
+        {
+            for (auto row = size_t(0); row < rows; ++row)
+            {
+                input.read((uint64_t(row) * columns + first) * sizeof(element),
+                           segment.data(), block * sizeof(element));
+                for (auto col = size_t(0); col < block; ++col)
+                    data[col * rows + row] = segment[col];
+            }
+            for (auto col = size_t(0); col < block; ++col)
+            {
+                auto line = data.data() + col * rows;
+                column_transform.execute(line, is_inverse);
+                for (auto k = size_t(0); k < rows; ++k)
+                    line[k] *= factors(uint64_t(first + col) * k);
+            }
+            for (auto row = size_t(0); row < rows; ++row)
+            {
+                for (auto col = size_t(0); col < block; ++col)
+                    segment[col] = data[col * rows + row];
+                temporary.write((uint64_t(row) * columns + first) * sizeof(element),
+                                segment.data(), block * sizeof(element));
+            }
+        }
+        ++ret.passes;
+    }
+
+    //pass 2: blocks of whole rows read at once, written transposed as one segment per column
+    {
+        file temporary(temporary_path, O_RDONLY);
+        auto block = std::min(rows, power_of_2_below(budget / columns));
+        memory::workspace<element> data(block * columns);
+        std::vector<element> segment(block);
+        file output(output_path, O_RDWR | O_CREAT | O_TRUNC);
+        output.resize(size * sizeof(element));
+        for (auto first = size_t(0); first < rows; first += block)
+        {
+            temporary.read(uint64_t(first) * columns * sizeof(element),
+                           data.data(), block * columns * sizeof(element));
+            for (auto row = size_t(0); row < block; ++row)
+                row_transform.execute(data.data() + row * columns, is_inverse);
+            for (auto col = size_t(0); col < columns; ++col)
+            {
+                for (auto row = size_t(0); row < block; ++row)
+                    segment[row] = data[row * columns + col];
+                output.write((uint64_t(col) * rows + first) * sizeof(element),
+                             segment.data(), block * sizeof(element));
+            }
+        }
+        ++ret.passes;
+    }
+
+    ret.bytes_read = ret.bytes_written = 2 * uint64_t(size) * sizeof(element);
+    return ret;
+}
+
+} //namespace detail
+
+//Transform of the whole input file written to output (which may be the same file),
+//using about memory_budget bytes for data; an output.partial file of the same size
+//holds the intermediate results. Needs the budget for sqrt(N) elements at least.
+template <typename T>
+report fft(const std::string& input, const std::string& output, size_t memory_budget)
+{
+    return detail::transform<T>(input, output, memory_budget, false);
+}
+
+template <typename T>
+report inv_fft(const std::string& input, const std::string& output, size_t memory_budget)
+{
+    return detail::transform<T>(input, output, memory_budget, true);
+}
+
+} //namespace out_of_core
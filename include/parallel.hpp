@@ -0,0 +1,64 @@
+#pragma once
+
+#include <thread>
+#include <vector>
+#include <exception>
+#include <algorithm>
+
+namespace parallel
+{
+
+inline size_t default_threads()
+{
+    auto ret = std::thread::hardware_concurrency();
+    return (ret == 0) ? 1 : ret;
+}
+
+//Calls function(begin, end) for contiguous chunks of [0, count), one chunk per thread.
+//The calling thread processes the first chunk; the first exception thrown is rethrown.
+//The other chunks run on threads started for this call, so their thread_local state
+//(fft plan caches, memory::workspace pools) starts empty every time: build plans on
+//the calling thread and share them, they are read only once built.
+template <typename Function>
+void for_ranges(size_t count, size_t threads, Function function)
+{
+    threads = std::max<size_t>(1, std::min(threads, count));
+    if (threads == 1)
+    {
+        if (count > 0) function(0, count);
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(threads);
+    auto run = [&](size_t index) {
+        try
+        {
+            function(count * index / threads, count * (index + 1) / threads);
+        }
+        catch (...)
+        {
+            errors[index] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (auto i = 1u; i < threads; ++i)
+        workers.emplace_back(run, i);
+    run(0);
+    for (auto& worker : workers)
+        worker.join();
+
+    for (auto& error : errors)
+        if (error) std::rethrow_exception(error);
+}
+
+template <typename Function>
+void for_each(size_t count, size_t threads, Function function)
+{
+    for_ranges(count, threads, [&](size_t begin, size_t end) {
+        for (auto i = begin; i < end; ++i)
+            function(i);
+    });
+}
+
+} //namespace parallel
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <complex>
+#include <stdexcept>
+#include "stft.hpp"
+#include "memory.hpp"
+#include "parallel.hpp"
+
+//Welch estimates of the one sided power spectral density of real signals: the
+//squared magnitudes of the windowed, overlapping segments are averaged. Every
+//thread transforms its segments one at a time into a workspace and accumulates
+//them right away, so memory stays O(segment size) whatever the signal length.
+
+namespace psd
+{
+
+//density is in power per unit of frequency (V^2 / Hz), spectrum in power per bin (V^2)
+enum class scaling
+{
+    density,
+    spectrum
+};
+
+template <typename T>
+class welch
+{
+public:
+    //segments of window.size() samples overlapping by overlap samples, zero padded to fft_size
+    welch(const std::vector<T>& window, size_t overlap, size_t fft_size = 0)
+        : segments_(window, checked_hop(window.size(), overlap), fft_size)
+    {}
+
+    size_t bins() const
+    {
+        return segments_.bins();
+    }
+
+    size_t segments(size_t samples) const
+    {
+        return segments_.frames(samples);
+    }
+
+    //frequency of every bin
+    std::vector<T> frequencies(T sample_rate) const
+    {
+        std::vector<T> ret(bins());
+        for (auto k = size_t(0); k < ret.size(); ++k)
+            ret[k] = T(k) * sample_rate / T(segments_.fft_size());
+        return ret;
+    }
+
+    std::vector<T> estimate(const T* signal, size_t samples, T sample_rate = T(1),
+                            scaling kind = scaling::density, size_t threads = 1) const
+    {
+        auto count = segments(samples);
+        if (count == 0)
+            throw std::runtime_error("signal is shorter than a welch segment");
+
+        std::vector<T> ret(bins(), T(0));
+        std::mutex merge;
+        parallel::for_ranges(count, threads, [&](size_t begin, size_t end) {
+            memory::workspace<std::complex<T>> spectrum(bins());
+            std::vector<T> power(bins(), T(0));
+            for (auto s = begin; s < end; ++s)
+            {
+                segments_.frame(signal + s * segments_.hop(), spectrum.data());
+                for (auto k = size_t(0); k < power.size(); ++k)
+                    power[k] += std::norm(spectrum[k]);
+            }
+            std::lock_guard<std::mutex> lock(merge);
+            for (auto k = size_t(0); k < ret.size(); ++k)
+                ret[k] += power[k];
+        });
+
+        auto sum = T(0), squares = T(0);
+        for (auto value : segments_.window())
+        {
+            sum += value;
+            squares += value * value;
+        }
+        auto scale = (kind == scaling::density) ? T(1) / (sample_rate * squares) : T(1) / (sum * sum);
+        scale /= T(count);
+        //the negative frequencies fold onto all bins but DC and Nyquist
+        for (auto k = size_t(0); k < ret.size(); ++k)
+            ret[k] *= ((k == 0) or (k + 1 == ret.size())) ? scale : 2 * scale;
+        return ret;
+    }
+
+    std::vector<T> estimate(const std::vector<T>& signal, T sample_rate = T(1),
+                            scaling kind = scaling::density, size_t threads = 1) const
+    {
+        return estimate(signal.data(), signal.size(), sample_rate, kind, threads);
+    }
+
+private:
+    static size_t checked_hop(size_t window, size_t overlap)
+    {
+        if (overlap >= window)
+            throw std::runtime_error("welch overlap has to be smaller than the segment");
+        return window - overlap;
+    }
+
+    stft::engine<T> segments_;
+};
+
+//single segment estimate, signal.size() has to equal window.size()
+template <typename T>
+std::vector<T> periodogram(const std::vector<T>& signal, const std::vector<T>& window,
+                           T sample_rate = T(1), scaling kind = scaling::density)
+{
+    if (signal.size() != window.size())
+        throw std::runtime_error("window and signal sizes differ");
+    return welch<T>(window, 0).estimate(signal, sample_rate, kind);
+}
+
+} //namespace psd
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include <stdexcept>
+#include "fft.hpp"
+#include "memory.hpp"
+
+//Spectrum of the last size samples of a real stream, updated in O(1) per tracked
+//bin and sample. The standard sliding DFT rotates every bin by its twiddle each
+//sample, so the rounding error of the twiddle compounds; the modulated variant
+//accumulates samples multiplied by exact table entries instead and rotates only
+//when the spectrum is read, which keeps the error growth linear. Both are
+//periodically recomputed from the samples with a real fft to bound the drift.
+
+namespace sliding
+{
+
+enum class variant
+{
+    standard,
+    modulated
+};
+
+template <typename T>
+class dft
+{
+public:
+    //resync_interval of 0 recomputes every 16 windows, the maximum of size_t never
+    dft(size_t size, std::vector<size_t> bins = std::vector<size_t>(),
+        variant kind = variant::modulated, size_t resync_interval = 0)
+        : size_(size),
+          kind_(kind),
+          resync_interval_((resync_interval == 0) ? 16 * size : resync_interval),
+          bins_(std::move(bins)),
+          samples_(size, T(0)),
+          position_(0),
+          since_resync_(0),
+          roots_re_(size),
+          roots_im_(size)
+    {
+        if ((size < 2) or not fft::impl::is_power_of_2(size))
+            throw std::runtime_error("sliding dft size has to be a power of two of at least 2");
+        if (bins_.empty())
+            for (auto k = size_t(0); k <= size / 2; ++k)
+                bins_.push_back(k);
+        for (auto k : bins_)
+            if (k >= size)
+                throw std::runtime_error("sliding dft bin out of range");
+
+        //exp(-2 pi i j / size)
+        static const long double pi = 3.141592653589793238462643383279502884L;
+        for (auto j = size_t(0); j < size; ++j)
+        {
+            auto angle = -2 * pi * (long double)(j) / (long double)(size);
+            roots_re_[j] = T(std::cos(angle));
+            roots_im_[j] = T(std::sin(angle));
+        }
+        //the standard update multiplies by exp(+2 pi i k / size)
+        for (auto k : bins_)
+        {
+            rotation_re_.push_back(roots_re_[k]);
+            rotation_im_.push_back(-roots_im_[k]);
+        }
+        re_.assign(bins_.size(), T(0));
+        im_.assign(bins_.size(), T(0));
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    const std::vector<size_t>& bins() const
+    {
+        return bins_;
+    }
+
+    void push(T sample)
+    {
+        auto delta = sample - samples_[position_];
+        samples_[position_] = sample;
+        if (kind_ == variant::standard)
+            rotate(delta);
+        else
+            modulate(delta, position_);
+        position_ = (position_ + 1) & (size_ - 1);
+        if (++since_resync_ >= resync_interval_) resync();
+    }
+
+    void push(const T* samples, size_t count)
+    {
+        for (auto i = size_t(0); i < count; ++i)
+            push(samples[i]);
+    }
+
+    //bin bins()[index] of the dft of the last size() samples, oldest first
+    std::complex<T> operator[](size_t index) const
+    {
+        if (kind_ == variant::standard)
+            return std::complex<T>(re_[index], im_[index]);
+        auto j = (bins_[index] * position_) & (size_ - 1);
+        return std::complex<T>(re_[index], im_[index]) * std::complex<T>(roots_re_[j], -roots_im_[j]);
+    }
+
+    fft::ComplexVec<T> spectrum() const
+    {
+        fft::ComplexVec<T> ret(bins_.size());
+        for (auto i = size_t(0); i < ret.size(); ++i)
+            ret[i] = (*this)[i];
+        return ret;
+    }
+
+    //recomputes the tracked bins from the last size() samples
+    void resync()
+    {
+        since_resync_ = 0;
+        memory::workspace<T> window(size_);
+        std::copy(samples_.begin() + position_, samples_.end(), window.data());
+        std::copy(samples_.begin(), samples_.begin() + position_, window.data() + size_ - position_);
+        std::shared_ptr<const fft::real_plan<T>> held;
+        auto& transform = fft::impl::real_plan_for<T>(size_, held);
+        memory::workspace<std::complex<T>> spectrum(transform.bins());
+        transform.execute(window.data(), spectrum.data());
+
+        for (auto i = size_t(0); i < bins_.size(); ++i)
+        {
+            auto k = bins_[i];
+            auto value = (k <= size_ / 2) ? spectrum[k] : std::conj(spectrum[size_ - k]);
+            if (kind_ == variant::modulated)
+            {
+                auto j = (k * position_) & (size_ - 1);
+                value *= std::complex<T>(roots_re_[j], roots_im_[j]);
+            }
+            re_[i] = value.real();
+            im_[i] = value.imag();
+        }
+    }
+
+    //back to a window of zeros
+    void reset()
+    {
+        std::fill(samples_.begin(), samples_.end(), T(0));
+        std::fill(re_.begin(), re_.end(), T(0));
+        std::fill(im_.begin(), im_.end(), T(0));
+        position_ = 0;
+        since_resync_ = 0;
+    }
+
+private:
+    //X = (X + x(n) - x(n - size)) exp(2 pi i k / size)
+    void rotate(T delta)
+    {
+        auto re = re_.data(), im = im_.data();
+        auto w_re = rotation_re_.data(), w_im = rotation_im_.data();
+        for (auto i = size_t(0); i < bins_.size(); ++i)
+        {
+            auto a_re = re[i] + delta, a_im = im[i];
+            re[i] = a_re * w_re[i] - a_im * w_im[i];
+            im[i] = a_re * w_im[i] + a_im * w_re[i];
+        }
+    }
+
+    //Y = Y + (x(n) - x(n - size)) exp(-2 pi i k n / size), read as X = Y exp(2 pi i k (n + 1) / size)
+    void modulate(T delta, size_t position)
+    {
+        for (auto i = size_t(0); i < bins_.size(); ++i)
+        {
+            auto j = (bins_[i] * position) & (size_ - 1);
+            re_[i] += delta * roots_re_[j];
+            im_[i] += delta * roots_im_[j];
+        }
+    }
+
+    size_t size_;
+    variant kind_;
+    size_t resync_interval_;
+    std::vector<size_t> bins_;
+    std::vector<T> samples_;
+    size_t position_;
+    size_t since_resync_;
+    std::vector<T> roots_re_;
+    std::vector<T> roots_im_;
+    std::vector<T> rotation_re_;
+    std::vector<T> rotation_im_;
+    std::vector<T> re_;
+    std::vector<T> im_;
+};
+
+} //namespace sliding
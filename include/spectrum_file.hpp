@@ -0,0 +1,297 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//Binary container of complex spectra: a fixed header describing the data followed
+//by the payload at a page aligned offset, so that memory mapped files hand their
+//values to the transforms (fft::fft_in_place, fft::plan::execute, ...) without copies.
+//Version 1 stores the values in host byte order; readers reject foreign byte orders.
+
+namespace spectrum_file
+{
+
+const uint32_t version = 1;
+const uint32_t byte_order_mark = 0x01020304u;
+const uint64_t payload_alignment = 4096;
+const size_t max_rank = 4;
+
+enum class dtype : uint32_t
+{
+    complex64 = 1,
+    complex128 = 2
+};
+
+//row_major: the last dimension of the shape is contiguous
+enum class layout : uint32_t
+{
+    row_major = 0,
+    column_major = 1
+};
+
+//where the 1 / N of a transform pair goes; this library's fft / inv_fft are backward
+enum class normalization : uint32_t
+{
+    backward = 0,
+    ortho = 1,
+    forward = 2
+};
+
+struct header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t type;
+    uint32_t layout;
+    uint32_t normalization;
+    uint32_t rank;
+    uint64_t shape[max_rank];
+    uint64_t payload_offset;
+    uint64_t payload_bytes;
+};
+
+namespace detail
+{
+
+const char magic[8] = {'F', 'F', 'T', 'S', 'P', 'E', 'C', '\0'};
+
+template <typename T>
+struct dtype_of;
+
+template <>
+struct dtype_of<float>
+{
+    static const dtype value = dtype::complex64;
+};
+
+template <>
+struct dtype_of<double>
+{
+    static const dtype value = dtype::complex128;
+};
+
+inline size_t element_bytes(dtype type)
+{
+    if (type == dtype::complex64) return sizeof(std::complex<float>);
+    if (type == dtype::complex128) return sizeof(std::complex<double>);
+    throw std::runtime_error("unknown spectrum dtype");
+}
+
+//bytes of a payload of the given shape, throws when they do not fit in 64 bits
+inline uint64_t payload_bytes(dtype type, const uint64_t* shape, size_t rank)
+{
+    const auto max = std::numeric_limits<uint64_t>::max();
+    auto count = uint64_t(1);
+    for (auto i = size_t(0); i < rank; ++i)
+    {
+        if ((shape[i] != 0) and (count > max / shape[i]))
+            throw std::runtime_error("spectrum shape is too big");
+        count *= shape[i];
+    }
+    auto element = element_bytes(type);
+    if (count > max / element)
+        throw std::runtime_error("spectrum shape is too big");
+    return count * element;
+}
+
+inline header make_header(dtype type, const std::vector<uint64_t>& shape,
+                          normalization norm, layout order)
+{
+    if (shape.empty() or (shape.size() > max_rank))
+        throw std::runtime_error("spectrum rank has to be between 1 and 4");
+
+    header ret;
+    std::memset(&ret, 0, sizeof(ret));
+    std::memcpy(ret.magic, magic, sizeof(magic));
+    ret.version = version;
+    ret.byte_order = byte_order_mark;
+    ret.type = uint32_t(type);
+    ret.layout = uint32_t(order);
+    ret.normalization = uint32_t(norm);
+    ret.rank = uint32_t(shape.size());
+    std::copy(shape.begin(), shape.end(), ret.shape);
+    ret.payload_offset = (sizeof(header) + payload_alignment - 1) / payload_alignment * payload_alignment;
+    ret.payload_bytes = payload_bytes(type, ret.shape, shape.size());
+    return ret;
+}
+
+inline void validate(const header& info, uint64_t file_size)
+{
+    if (std::memcmp(info.magic, magic, sizeof(magic)) != 0)
+        throw std::runtime_error("not a spectrum file");
+    if (info.version != version)
+        throw std::runtime_error("unsupported spectrum file version " + std::to_string(info.version));
+    if (info.byte_order != byte_order_mark)
+        throw std::runtime_error("spectrum file has a foreign byte order");
+    if ((info.rank == 0) or (info.rank > max_rank))
+        throw std::runtime_error("invalid spectrum rank");
+    if (info.layout > uint32_t(layout::column_major))
+        throw std::runtime_error("invalid spectrum layout");
+    if (info.normalization > uint32_t(normalization::forward))
+        throw std::runtime_error("invalid spectrum normalization");
+
+    if ((info.payload_bytes != payload_bytes(dtype(info.type), info.shape, info.rank))
+        or (info.payload_offset % payload_alignment != 0)
+        or (info.payload_offset > file_size)
+        or (info.payload_bytes > file_size - info.payload_offset))
+        throw std::runtime_error("truncated or inconsistent spectrum file");
+}
+
+} //namespace detail
+
+//Memory mapped spectrum file. Read only opens map it privately (copy on write), so
+//the payload can still be transformed in place without touching the file; read
+//write ones map it shared, changes going straight to the file and to other processes.
+class mapped
+{
+public:
+    enum class access { read_only, read_write };
+
+    explicit mapped(const std::string& path, access mode = access::read_only)
+        : mapped(open(path, mode), mode)
+    {}
+
+    mapped(const mapped&) = delete;
+    mapped& operator=(const mapped&) = delete;
+
+    mapped(mapped&& other) : base_(other.base_), bytes_(other.bytes_)
+    {
+        other.base_ = nullptr;
+    }
+
+    ~mapped()
+    {
+        if (base_ != nullptr) munmap(base_, bytes_);
+    }
+
+    const header& info() const
+    {
+        return *static_cast<const header*>(base_);
+    }
+
+    dtype type() const
+    {
+        return dtype(info().type);
+    }
+
+    normalization convention() const
+    {
+        return normalization(info().normalization);
+    }
+
+    layout order() const
+    {
+        return layout(info().layout);
+    }
+
+    std::vector<uint64_t> shape() const
+    {
+        return std::vector<uint64_t>(info().shape, info().shape + info().rank);
+    }
+
+    //number of complex values
+    uint64_t size() const
+    {
+        return info().payload_bytes / detail::element_bytes(type());
+    }
+
+    //the payload itself, throws when T does not match the stored dtype
+    template <typename T>
+    std::complex<T>* data() const
+    {
+        if (type() != detail::dtype_of<T>::value)
+            throw std::runtime_error("spectrum file holds another dtype");
+        return reinterpret_cast<std::complex<T>*>(static_cast<char*>(base_) + info().payload_offset);
+    }
+
+private:
+    struct opened
+    {
+        void* base;
+        size_t bytes;
+    };
+
+    mapped(opened arg, access) : base_(arg.base), bytes_(arg.bytes) {}
+
+    static opened open(const std::string& path, access mode)
+    {
+        auto writable = (mode == access::read_write);
+        auto descriptor = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+        if (descriptor < 0)
+            throw std::runtime_error("cannot open " + path);
+
+        struct stat status;
+        if ((::fstat(descriptor, &status) != 0) or (uint64_t(status.st_size) < sizeof(header)))
+        {
+            ::close(descriptor);
+            throw std::runtime_error("not a spectrum file: " + path);
+        }
+        auto bytes = size_t(status.st_size);
+        auto base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, writable ? MAP_SHARED : MAP_PRIVATE,
+                         descriptor, 0);
+        ::close(descriptor);
+        if (base == MAP_FAILED)
+            throw std::runtime_error("cannot map " + path);
+
+        try
+        {
+            detail::validate(*static_cast<const header*>(base), bytes);
+        }
+        catch (...)
+        {
+            munmap(base, bytes);
+            throw;
+        }
+        return {base, bytes};
+    }
+
+    void* base_;
+    size_t bytes_;
+};
+
+//New file of the given shape with a zeroed payload, mapped for writing, so that
+//producers fill (or transform) the payload in place.
+template <typename T>
+mapped create(const std::string& path, const std::vector<uint64_t>& shape,
+              normalization norm = normalization::backward, layout order = layout::row_major)
+{
+    auto info = detail::make_header(detail::dtype_of<T>::value, shape, norm, order);
+    auto descriptor = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (descriptor < 0)
+        throw std::runtime_error("cannot create " + path);
+    auto written = ::pwrite(descriptor, &info, sizeof(info), 0);
+    auto resized = ::ftruncate(descriptor, off_t(info.payload_offset + info.payload_bytes));
+    ::close(descriptor);
+    if ((written != ssize_t(sizeof(info))) or (resized != 0))
+        throw std::runtime_error("cannot write " + path);
+    return mapped(path, mapped::access::read_write);
+}
+
+template <typename T>
+void write(const std::string& path, const std::complex<T>* values, const std::vector<uint64_t>& shape,
+           normalization norm = normalization::backward, layout order = layout::row_major)
+{
+    auto file = create<T>(path, shape, norm, order);
+    std::memcpy(file.template data<T>(), values, file.info().payload_bytes);
+}
+
+template <typename T>
+void write(const std::string& path, const std::vector<std::complex<T>>& values,
+           normalization norm = normalization::backward)
+{
+    write(path, values.data(), {uint64_t(values.size())}, norm);
+}
+
+} //namespace spectrum_file
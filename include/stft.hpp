@@ -0,0 +1,266 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include <stdexcept>
+#include "fft.hpp"
+#include "memory.hpp"
+#include "parallel.hpp"
+
+//Short-time Fourier transform of real signals: frames of window.size() samples are
+//taken every hop samples, multiplied by the window, zero padded to fft_size and
+//transformed with a real fft, so a spectrogram holds frames x (fft_size / 2 + 1)
+//values, row major. The inverse overlap-adds the windowed frames and divides by
+//the overlapping sum of the squared window, which undoes any window and hop.
+
+namespace stft
+{
+
+template <typename T>
+class engine
+{
+public:
+    engine(std::vector<T> window, size_t hop, size_t fft_size = 0)
+        : window_(std::move(window)),
+          hop_(hop),
+          transform_((fft_size == 0) ? window_.size() : fft_size),
+          norm_floor_(0)
+    {
+        if ((hop == 0) or (hop > window_.size()))
+            throw std::runtime_error("stft hop has to be between 1 and the window size");
+        if (window_.size() > transform_.size())
+            throw std::runtime_error("stft window is longer than the fft size");
+
+        //below it the squared window sum only amplifies rounding errors
+        for (auto value : window_)
+            norm_floor_ = std::max(norm_floor_, value * value);
+        norm_floor_ *= std::numeric_limits<T>::epsilon();
+    }
+
+    const std::vector<T>& window() const
+    {
+        return window_;
+    }
+
+    size_t window_size() const
+    {
+        return window_.size();
+    }
+
+    size_t hop() const
+    {
+        return hop_;
+    }
+
+    size_t fft_size() const
+    {
+        return transform_.size();
+    }
+
+    size_t bins() const
+    {
+        return transform_.bins();
+    }
+
+    //frames lying entirely inside a signal of the given length
+    size_t frames(size_t samples) const
+    {
+        return (samples < window_.size()) ? 0 : (samples - window_.size()) / hop_ + 1;
+    }
+
+    //length of the signal the inverse makes of that many frames
+    size_t samples(size_t frames) const
+    {
+        return (frames == 0) ? 0 : (frames - 1) * hop_ + window_.size();
+    }
+
+    //bins() values of window_size() samples
+    void frame(const T* samples, std::complex<T>* output) const
+    {
+        transform_.execute(samples, window_.size(), window_.data(), output);
+    }
+
+    //frames(samples) rows of bins() values, the frames split between threads
+    void forward(const T* input, size_t samples, std::complex<T>* output, size_t threads = 1) const
+    {
+        parallel::for_ranges(frames(samples), threads, [&](size_t begin, size_t end) {
+            for (auto f = begin; f < end; ++f)
+                frame(input + f * hop_, output + f * bins());
+        });
+    }
+
+    fft::ComplexVec<T> forward(const std::vector<T>& input, size_t threads = 1) const
+    {
+        fft::ComplexVec<T> ret(frames(input.size()) * bins());
+        forward(input.data(), input.size(), ret.data(), threads);
+        return ret;
+    }
+
+    //windowed time frame of bins() values, fft_size() samples of scratch
+    void synthesize(const std::complex<T>* spectrum, T* scratch) const
+    {
+        transform_.inverse(spectrum, scratch);
+        for (auto i = size_t(0); i < window_.size(); ++i)
+            scratch[i] *= window_[i];
+    }
+
+    //output[i] = accumulated[i] / norm[i] where the window covers the sample enough
+    void normalize(const T* accumulated, const T* norm, size_t count, T* output) const
+    {
+        for (auto i = size_t(0); i < count; ++i)
+            output[i] = (norm[i] > norm_floor_) ? accumulated[i] / norm[i] : T(0);
+    }
+
+    //samples(frames) samples from frames rows of bins() values; the inverse
+    //transforms of a block of frames run on threads, the overlap-add on the caller
+    std::vector<T> inverse(const std::complex<T>* spectrogram, size_t frames, size_t threads = 1) const
+    {
+        std::vector<T> ret(samples(frames), T(0));
+        std::vector<T> norm(ret.size(), T(0));
+        auto block = std::max<size_t>(threads, 1) * 16;
+        memory::workspace<T> scratch(std::min(block, frames) * fft_size());
+        for (auto first = size_t(0); first < frames; first += block)
+        {
+            auto count = std::min(block, frames - first);
+            parallel::for_ranges(count, threads, [&](size_t begin, size_t end) {
+                for (auto f = begin; f < end; ++f)
+                    synthesize(spectrogram + (first + f) * bins(), scratch.data() + f * fft_size());
+            });
+            for (auto f = size_t(0); f < count; ++f)
+            {
+                auto offset = (first + f) * hop_;
+                auto values = scratch.data() + f * fft_size();
+                for (auto i = size_t(0); i < window_.size(); ++i)
+                {
+                    ret[offset + i] += values[i];
+                    norm[offset + i] += window_[i] * window_[i];
+                }
+            }
+        }
+        normalize(ret.data(), norm.data(), ret.size(), ret.data());
+        return ret;
+    }
+
+    std::vector<T> inverse(const fft::ComplexVec<T>& spectrogram, size_t threads = 1) const
+    {
+        return inverse(spectrogram.data(), spectrogram.size() / bins(), threads);
+    }
+
+private:
+    std::vector<T> window_;
+    size_t hop_;
+    fft::real_plan<T> transform_;
+    T norm_floor_;
+};
+
+//Push based forward transform keeping only the last window_size() samples; the
+//engine has to outlive it.
+template <typename T>
+class analyzer
+{
+public:
+    explicit analyzer(const engine<T>& transform)
+        : engine_(transform),
+          pending_(transform.window_size()),
+          filled_(0),
+          spectrum_(transform.bins())
+    {}
+
+    //calls on_frame(const std::complex<T>* bins) for every frame the samples complete
+    template <typename Callback>
+    void push(const T* samples, size_t count, Callback on_frame)
+    {
+        auto window = pending_.size();
+        while (count > 0)
+        {
+            auto taken = std::min(window - filled_, count);
+            std::copy(samples, samples + taken, pending_.begin() + filled_);
+            filled_ += taken;
+            samples += taken;
+            count -= taken;
+            if (filled_ < window) break;
+
+            engine_.frame(pending_.data(), spectrum_.data());
+            on_frame(static_cast<const std::complex<T>*>(spectrum_.data()));
+            std::copy(pending_.begin() + engine_.hop(), pending_.end(), pending_.begin());
+            filled_ = window - engine_.hop();
+        }
+    }
+
+    void reset()
+    {
+        filled_ = 0;
+    }
+
+private:
+    const engine<T>& engine_;
+    std::vector<T> pending_;
+    size_t filled_;
+    fft::ComplexVec<T> spectrum_;
+};
+
+//Push based inverse: every frame completes hop() samples of the signal, which
+//no later frame overlaps; memory stays at a few window sizes. The engine has to
+//outlive it.
+template <typename T>
+class synthesizer
+{
+public:
+    //The vectors are sized in the body: built one after another in the init list, the
+    //inlined cleanup of the first ones when a later one throws trips a GCC 12 bug, a
+    //false -Wfree-nonheap-object warning about freeing the member addresses.
+    explicit synthesizer(const engine<T>& transform)
+        : engine_(transform)
+    {
+        accumulated_.assign(transform.window_size(), T(0));
+        norm_.assign(transform.window_size(), T(0));
+        scratch_.resize(transform.fft_size());
+        ready_.resize(transform.window_size());
+    }
+
+    //adds the frame of bins() values and calls on_samples(const T* samples, size_t count)
+    template <typename Callback>
+    void push(const std::complex<T>* frame, Callback on_samples)
+    {
+        auto& window = engine_.window();
+        engine_.synthesize(frame, scratch_.data());
+        for (auto i = size_t(0); i < window.size(); ++i)
+        {
+            accumulated_[i] += scratch_[i];
+            norm_[i] += window[i] * window[i];
+        }
+        emit(engine_.hop(), on_samples);
+    }
+
+    //the samples only partially overlapped by the frames pushed so far
+    template <typename Callback>
+    void flush(Callback on_samples)
+    {
+        emit(engine_.window_size() - engine_.hop(), on_samples);
+        std::fill(accumulated_.begin(), accumulated_.end(), T(0));
+        std::fill(norm_.begin(), norm_.end(), T(0));
+    }
+
+private:
+    template <typename Callback>
+    void emit(size_t count, Callback on_samples)
+    {
+        engine_.normalize(accumulated_.data(), norm_.data(), count, ready_.data());
+        on_samples(static_cast<const T*>(ready_.data()), count);
+        std::copy(accumulated_.begin() + count, accumulated_.end(), accumulated_.begin());
+        std::copy(norm_.begin() + count, norm_.end(), norm_.begin());
+        std::fill(accumulated_.end() - count, accumulated_.end(), T(0));
+        std::fill(norm_.end() - count, norm_.end(), T(0));
+    }
+
+    const engine<T>& engine_;
+    std::vector<T> accumulated_;
+    std::vector<T> norm_;
+    std::vector<T> scratch_;
+    std::vector<T> ready_;
+};
+
+} //namespace stft
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <map>
+#include <cmath>
+#include <tuple>
+#include <memory>
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include <stdexcept>
+#include "fft.hpp"
+
+//Window functions evaluated in long double and rounded once to T. Periodic
+//windows (the default, for spectral analysis) are the symmetric ones of size + 1
+//without the last value. cached() keeps every window per thread, so that repeated
+//transforms do not recompute them; the transforms below apply the window in the
+//pass which puts the input into bit reversed order instead of a separate one.
+
+namespace window
+{
+
+//the parameter is beta of kaiser, the tapered fraction of tukey and the time
+//half bandwidth NW of dpss (the first Slepian sequence); the others have none
+enum class shape
+{
+    hann,
+    hamming,
+    blackman_harris,
+    flat_top,
+    kaiser,
+    tukey,
+    dpss
+};
+
+enum class symmetry
+{
+    periodic,
+    symmetric
+};
+
+namespace detail
+{
+
+using values = std::vector<long double>;
+
+const long double pi = 3.141592653589793238462643383279502884L;
+
+inline values cosine_sum(size_t size, std::initializer_list<long double> coefficients)
+{
+    values ret(size, 0.0L);
+    for (auto n = size_t(0); n < size; ++n)
+    {
+        auto sign = 1.0L, k = 0.0L;
+        for (auto a : coefficients)
+        {
+            ret[n] += sign * a * std::cos(2 * pi * k * n / (size - 1));
+            sign = -sign;
+            k += 1;
+        }
+    }
+    return ret;
+}
+
+//modified Bessel function of the first kind of order 0
+inline long double bessel_i0(long double x)
+{
+    auto ret = 1.0L, term = 1.0L;
+    for (auto k = 1; term > ret * 1.0e-21L; ++k)
+    {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        ret += term;
+    }
+    return ret;
+}
+
+inline values kaiser(size_t size, long double beta)
+{
+    values ret(size);
+    for (auto n = size_t(0); n < size; ++n)
+    {
+        auto r = 2.0L * n / (size - 1) - 1;
+        ret[n] = bessel_i0(beta * std::sqrt(std::max(0.0L, 1 - r * r))) / bessel_i0(beta);
+    }
+    return ret;
+}
+
+inline values tukey(size_t size, long double alpha)
+{
+    values ret(size, 1.0L);
+    if (alpha <= 0) return ret;
+    alpha = std::min(alpha, 1.0L);
+    auto edge = alpha * (size - 1) / 2;
+    for (auto n = size_t(0); n < size; ++n)
+    {
+        auto distance = std::min<long double>(n, size - 1 - n);
+        if (distance < edge)
+            ret[n] = 0.5L - 0.5L * std::cos(pi * distance / edge);
+    }
+    return ret;
+}
+
+//The first Slepian sequence is the eigenvector of the largest eigenvalue of a
+//symmetric tridiagonal matrix: the eigenvalue is found by bisection over Sturm
+//counts, the vector by inverse iteration.
+inline values dpss(size_t size, long double half_bandwidth)
+{
+    auto bandwidth = half_bandwidth / size;
+    values diagonal(size), off(size, 0.0L);
+    for (auto n = size_t(0); n < size; ++n)
+    {
+        auto centered = (size - 1 - 2.0L * n) / 2;
+        diagonal[n] = centered * centered * std::cos(2 * pi * bandwidth);
+        off[n] = (n == 0) ? 0.0L : n * (size - n) / 2.0L;
+    }
+
+    auto below = [&](long double x) {
+        auto count = size_t(0);
+        auto pivot = 1.0L;
+        for (auto n = size_t(0); n < size; ++n)
+        {
+            pivot = diagonal[n] - x - ((n == 0) ? 0.0L : off[n] * off[n] / pivot);
+            if (pivot == 0) pivot = 1.0e-30L;
+            if (pivot < 0) ++count;
+        }
+        return count;
+    };
+    auto low = diagonal[0], high = diagonal[0];
+    for (auto n = size_t(0); n < size; ++n)
+    {
+        auto radius = off[n] + ((n + 1 < size) ? off[n + 1] : 0.0L);
+        low = std::min(low, diagonal[n] - radius);
+        high = std::max(high, diagonal[n] + radius);
+    }
+    for (auto i = 0; i < 200; ++i)
+    {
+        auto middle = (low + high) / 2;
+        if (below(middle) == size)
+            high = middle;
+        else
+            low = middle;
+    }
+    auto eigenvalue = high;
+
+    values ret(size, 1.0L), upper(size);
+    for (auto iteration = 0; iteration < 3; ++iteration)
+    {
+        //Thomas algorithm for (matrix - eigenvalue) x = ret
+        for (auto n = size_t(0); n < size; ++n)
+        {
+            auto pivot = diagonal[n] - eigenvalue;
+            if (n > 0)
+            {
+                pivot -= off[n] * upper[n - 1];
+                ret[n] -= off[n] * ret[n - 1];
+            }
+            if (pivot == 0) pivot = 1.0e-30L;
+            upper[n] = ((n + 1 < size) ? off[n + 1] : 0.0L) / pivot;
+            ret[n] /= pivot;
+        }
+        for (auto n = size - 1; n > 0; --n)
+            ret[n - 1] -= upper[n - 1] * ret[n];
+
+        auto largest = 0.0L;
+        for (auto value : ret)
+            if (std::abs(value) > std::abs(largest)) largest = value;
+        for (auto& value : ret)
+            value /= largest;
+    }
+    return ret;
+}
+
+inline values symmetric(shape type, size_t size, long double parameter)
+{
+    if (size <= 1) return values(size, 1.0L);
+    switch (type)
+    {
+        case shape::hann: return cosine_sum(size, {0.5L, 0.5L});
+        case shape::hamming: return cosine_sum(size, {0.54L, 0.46L});
+        case shape::blackman_harris: return cosine_sum(size, {0.35875L, 0.48829L, 0.14128L, 0.01168L});
+        case shape::flat_top:
+            return cosine_sum(size, {0.21557895L, 0.41663158L, 0.277263158L, 0.083578947L, 0.006947368L});
+        case shape::kaiser: return kaiser(size, parameter);
+        case shape::tukey: return tukey(size, parameter);
+        case shape::dpss: return dpss(size, parameter);
+    }
+    throw std::runtime_error("unknown window shape");
+}
+
+inline bool has_parameter(shape type)
+{
+    return (type == shape::kaiser) or (type == shape::tukey) or (type == shape::dpss);
+}
+
+} //namespace detail
+
+template <typename T>
+std::vector<T> make(shape type, size_t size, double parameter = 0.0, symmetry kind = symmetry::periodic)
+{
+    auto periodic = (kind == symmetry::periodic) and (size > 1);
+    auto values = detail::symmetric(type, periodic ? size + 1 : size, parameter);
+    return std::vector<T>(values.begin(), values.begin() + size);
+}
+
+//the same window as make(), computed once per thread
+template <typename T>
+const std::vector<T>& cached(shape type, size_t size, double parameter = 0.0,
+                             symmetry kind = symmetry::periodic)
+{
+    if (not detail::has_parameter(type)) parameter = 0.0;
+    using key = std::tuple<shape, size_t, double, symmetry>;
+    static thread_local std::map<key, std::unique_ptr<const std::vector<T>>> cache;
+    auto& ret = cache[key(type, size, parameter, kind)];
+    if (not ret)
+        ret.reset(new std::vector<T>(make<T>(type, size, parameter, kind)));
+    return *ret;
+}
+
+//spectrum of input[i] * window[i]
+template <typename T>
+fft::ComplexVec<T> fft(const fft::ComplexVec<T>& input, const std::vector<T>& window)
+{
+    if (input.size() != window.size())
+        throw std::runtime_error("window and input sizes differ");
+    fft::ComplexVec<T> ret(input.size());
+    std::shared_ptr<const fft::plan<T>> held;
+    fft::impl::plan_for<T>(input.size(), held).execute(input.data(), window.data(), ret.data());
+    return ret;
+}
+
+//the size / 2 + 1 non negative frequency bins of input[i] * window[i]
+template <typename T>
+fft::ComplexVec<T> real_fft(const std::vector<T>& input, const std::vector<T>& window)
+{
+    if (input.size() != window.size())
+        throw std::runtime_error("window and input sizes differ");
+    if (input.size() <= 1)
+        return fft::ComplexVec<T>(input.size(), (input.empty()) ? T(0) : input[0] * window[0]);
+    std::shared_ptr<const fft::real_plan<T>> held;
+    auto& transform = fft::impl::real_plan_for<T>(input.size(), held);
+    fft::ComplexVec<T> ret(transform.bins());
+    transform.execute(input.data(), input.size(), window.data(), ret.data());
+    return ret;
+}
+
+} //namespace window
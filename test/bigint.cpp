@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include "bigint.hpp"
+#include <random>
+
+std::vector<uint32_t> random_limbs(size_t size)
+{
+    static std::mt19937 rd;
+    std::uniform_int_distribution<uint32_t> dist(0, bigint::limb_base - 1);
+    std::vector<uint32_t> ret(size);
+    for (auto& elem : ret) elem = dist(rd);
+    ret.back() = 1 + ret.back() % (bigint::limb_base - 1);
+    return ret;
+}
+
+TEST(BigintTest, decimal_conversions)
+{
+    for (auto text : {"1", "9999", "10000", "123456789012345678901234567890"})
+        ASSERT_EQ(text, bigint::natural(text).to_string());
+    ASSERT_EQ("0", bigint::natural("0000").to_string());
+    ASSERT_EQ("120", bigint::natural("000120").to_string());
+    ASSERT_EQ(bigint::natural("18446744073709551615"), bigint::natural(18446744073709551615ull));
+    ASSERT_THROW(bigint::natural("12a"), std::invalid_argument);
+}
+
+TEST(BigintTest, multiply_known_values)
+{
+    auto product = bigint::natural("12345678901234567890") * bigint::natural("98765432109876543210");
+    ASSERT_EQ("1219326311370217952237463801111263526900", product.to_string());
+    ASSERT_EQ("0", (bigint::natural("0") * bigint::natural("123")).to_string());
+}
+
+TEST(BigintTest, all_methods_agree_with_schoolbook)
+{
+    for (auto sizes : {std::make_pair(1u, 1u), std::make_pair(40u, 33u), std::make_pair(300u, 35u),
+                       std::make_pair(500u, 700u), std::make_pair(1500u, 1100u),
+                       std::make_pair(5000u, 1024u)})
+    {
+        auto first = random_limbs(sizes.first);
+        auto second = random_limbs(sizes.second);
+        auto expected = bigint::detail::propagate_carries(bigint::detail::schoolbook(
+            bigint::detail::coefficients(first.begin(), first.end()),
+            bigint::detail::coefficients(second.begin(), second.end())));
+        ASSERT_EQ(expected, bigint::multiply(first, second))
+            << "sizes " << sizes.first << " and " << sizes.second;
+    }
+}
+
+TEST(BigintTest, square_of_many_nines)
+{
+    auto digits = 20001u;
+    auto nines = bigint::natural(std::string(digits, '9'));
+    auto expected = std::string(digits - 1, '9') + "8" + std::string(digits - 1, '0') + "1";
+    ASSERT_EQ(expected, (nines * nines).to_string());
+}
@@ -115,3 +115,149 @@ TEST(ConvolutionTest, DISABLED_big_2d_convolution)
     ASSERT_NO_FATAL_FAILURE(equal(expected, result));
 }
 
+
+TEST(ConvolutionTest, filter_matches_convolve)
+{
+    auto kernel = generate(9);
+    convolution::filter<double> prepared(kernel);
+    for (auto size : {9u, 16u, 100u, 9u, 1000u, 100u})
+    {
+        auto vals = generate(size);
+        auto expected = convolution::convolve(vals, kernel);
+        ASSERT_NO_FATAL_FAILURE(equal(expected, prepared(vals))) << "size " << size;
+    }
+    ASSERT_EQ(3u, prepared.cached_spectra());
+}
+
+TEST(ConvolutionTest, filter_cache_is_bounded)
+{
+    auto kernel = generate(3);
+    auto budget = 64 * sizeof(std::complex<double>);
+    convolution::filter<double> prepared(kernel, budget);
+    for (auto size : {4u, 13u, 29u, 61u, 200u})
+    {
+        auto vals = generate(size);
+        ASSERT_NO_FATAL_FAILURE(equal(naive_convolve(vals, kernel), prepared(vals)));
+        ASSERT_TRUE((prepared.cached_bytes() <= budget) or (prepared.cached_spectra() == 1));
+    }
+    ASSERT_EQ(1u, prepared.cached_spectra());
+    ASSERT_EQ(256 * sizeof(std::complex<double>), prepared.cached_bytes());
+}
+
+template <typename T>
+std::vector<T> naive_full_convolve_2d(const std::vector<T>& first, size_t first_width,
+                                      const std::vector<T>& second, size_t second_width)
+{
+    auto first_height = first.size() / first_width;
+    auto second_height = second.size() / second_width;
+    auto width = first_width + second_width - 1;
+    std::vector<T> ret(width * (first_height + second_height - 1), 0);
+    for (auto y = 0u; y < first_height; ++y)
+        for (auto x = 0u; x < first_width; ++x)
+            for (auto kern_y = 0u; kern_y < second_height; ++kern_y)
+                for (auto kern_x = 0u; kern_x < second_width; ++kern_x)
+                    ret[(y + kern_y) * width + x + kern_x] +=
+                        first[y * first_width + x] * second[kern_y * second_width + kern_x];
+    return ret;
+}
+
+template <typename T>
+std::vector<T> crop(const std::vector<T>& full, size_t full_width,
+                    size_t first_row, size_t rows, size_t first_col, size_t cols)
+{
+    std::vector<T> ret;
+    for (auto row = first_row; row < first_row + rows; ++row)
+        for (auto col = first_col; col < first_col + cols; ++col)
+            ret.push_back(full[row * full_width + col]);
+    return ret;
+}
+
+TEST(ConvolutionTest, convolution_modes_1d)
+{
+    using convolution::mode;
+    for (auto i : {1u, 2u, 7u, 16u, 33u, 100u})
+    {
+        for (auto j : {1u, 2u, 5u, 16u, 33u})
+        {
+            if (j > i) continue;
+            auto vals = generate(i);
+            auto filter = generate(j);
+            auto full = naive_full_convolve_2d(vals, i, filter, j);
+
+            ASSERT_NO_FATAL_FAILURE(equal(full, convolution::convolve(vals, filter, mode::full)));
+            ASSERT_NO_FATAL_FAILURE(equal(
+                crop(full, full.size(), 0, 1, (j - 1) / 2, i),
+                convolution::convolve(vals, filter, mode::same)));
+            ASSERT_NO_FATAL_FAILURE(equal(
+                crop(full, full.size(), 0, 1, j - 1, i - j + 1),
+                convolution::convolve(vals, filter, mode::valid)));
+        }
+    }
+    ASSERT_THROW(convolution::convolve(generate(3), generate(4), mode::valid), std::runtime_error);
+}
+
+TEST(ConvolutionTest, convolution_modes_2d)
+{
+    using convolution::mode;
+    for (auto width : {4u, 11u})
+    {
+        for (auto height : {3u, 8u})
+        {
+            for (auto kern_width : {1u, 2u, 3u})
+            {
+                for (auto kern_height : {1u, 3u})
+                {
+                    auto vals = generate(width * height);
+                    auto filter = generate(kern_width * kern_height);
+                    auto full = naive_full_convolve_2d(vals, width, filter, kern_width);
+                    auto full_width = width + kern_width - 1;
+
+                    ASSERT_NO_FATAL_FAILURE(equal(
+                        full,
+                        convolution::convolve_2d(vals, width, filter, kern_width, mode::full)));
+                    ASSERT_NO_FATAL_FAILURE(equal(
+                        crop(full, full_width, (kern_height - 1) / 2, height,
+                                               (kern_width - 1) / 2, width),
+                        convolution::convolve_2d(vals, width, filter, kern_width, mode::same)));
+                    ASSERT_NO_FATAL_FAILURE(equal(
+                        crop(full, full_width, kern_height - 1, height - kern_height + 1,
+                                               kern_width - 1, width - kern_width + 1),
+                        convolution::convolve_2d(vals, width, filter, kern_width, mode::valid)))
+                        << "sizes: " << height << "x" << width << " and "
+                        << kern_height << "x" << kern_width;
+                }
+            }
+        }
+    }
+}
+
+TEST(ConvolutionTest, batch_convolution_matches_single_convolutions)
+{
+    using convolution::mode;
+    std::vector<std::vector<double>> channels, filters;
+    for (auto i = 0u; i < 5; ++i) channels.push_back(generate(60));
+    for (auto i = 0u; i < 3; ++i) filters.push_back(generate(7));
+
+    for (auto threads : {1u, 4u})
+    {
+        for (auto output_mode : {mode::full, mode::same, mode::valid})
+        {
+            auto result = convolution::convolve_batch(channels, filters, output_mode, threads);
+            ASSERT_EQ(channels.size(), result.size());
+            for (auto channel = 0u; channel < channels.size(); ++channel)
+            {
+                ASSERT_EQ(filters.size(), result[channel].size());
+                for (auto filter = 0u; filter < filters.size(); ++filter)
+                {
+                    auto expected = convolution::convolve(
+                        channels[channel], filters[filter], output_mode);
+                    ASSERT_NO_FATAL_FAILURE(equal(expected, result[channel][filter]))
+                        << "channel " << channel << ", filter " << filter;
+                }
+            }
+        }
+    }
+
+    filters.push_back(generate(8));
+    ASSERT_THROW(convolution::convolve_batch(channels, filters, mode::full), std::runtime_error);
+}
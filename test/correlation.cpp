@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include "correlation.hpp"
+#include "generator.hpp"
+#include "equality_checks.hpp"
+#include <cmath>
+
+using correlation::mode;
+
+//plain sum over the overlap of the signal and the template shifted by every lag of the mode
+template <typename T>
+std::vector<T> naive_correlate_2d(const std::vector<T>& signal, size_t width,
+                                  const std::vector<T>& pattern, size_t pattern_width,
+                                  mode output_mode, bool normalize = false)
+{
+    long height = signal.size() / width;
+    long pattern_height = pattern.size() / pattern_width;
+    auto rows = correlation::detail::lags(output_mode, height, pattern_height);
+    auto cols = correlation::detail::lags(output_mode, width, pattern_width);
+
+    std::vector<T> ret;
+    for (auto row = rows.first; row < rows.first + long(rows.count); ++row)
+    {
+        for (auto col = cols.first; col < cols.first + long(cols.count); ++col)
+        {
+            std::vector<T> window;
+            for (auto y = 0l; y < pattern_height; ++y)
+            {
+                for (auto x = 0l; x < long(pattern_width); ++x)
+                {
+                    auto src_y = row + y;
+                    auto src_x = col + x;
+                    auto inside = (src_y >= 0) and (src_y < height)
+                              and (src_x >= 0) and (src_x < long(width));
+                    window.push_back(inside ? signal[src_y * width + src_x] : T());
+                }
+            }
+
+            T window_mean = T(), pattern_mean = T();
+            if (normalize)
+            {
+                for (auto i = 0u; i < window.size(); ++i)
+                {
+                    window_mean += window[i] / window.size();
+                    pattern_mean += pattern[i] / pattern.size();
+                }
+            }
+
+            T sum = T(), window_energy = T(), pattern_energy = T();
+            for (auto i = 0u; i < window.size(); ++i)
+            {
+                sum += (window[i] - window_mean) * (pattern[i] - pattern_mean);
+                window_energy += (window[i] - window_mean) * (window[i] - window_mean);
+                pattern_energy += (pattern[i] - pattern_mean) * (pattern[i] - pattern_mean);
+            }
+            if (normalize)
+                sum = (window_energy > 1e-9) ? sum / std::sqrt(window_energy * pattern_energy) : T();
+            ret.push_back(sum);
+        }
+    }
+    return ret;
+}
+
+TEST(CorrelationTest, correlate_1d_all_modes)
+{
+    for (auto i : {1u, 2u, 7u, 16u, 33u, 100u})
+    {
+        for (auto j : {1u, 2u, 5u, 16u, 33u})
+        {
+            if (j > i) continue;
+            auto signal = generate(i);
+            auto pattern = generate(j);
+            for (auto output_mode : {mode::full, mode::same, mode::valid})
+            {
+                auto expected = naive_correlate_2d(signal, i, pattern, j, output_mode);
+                auto result = correlation::correlate(signal, pattern, output_mode);
+                ASSERT_NO_FATAL_FAILURE(equal(expected, result))
+                    << "sizes: " << i << " and " << j << ", mode " << int(output_mode);
+            }
+        }
+    }
+}
+
+TEST(CorrelationTest, correlate_1d_full_has_all_lags)
+{
+    auto result = correlation::correlate<double>({1, 2, 3}, {1, 1});
+    ASSERT_NO_FATAL_FAILURE(near(std::vector<double>{1, 3, 5, 3}, result, 1.0e-9));
+}
+
+TEST(CorrelationTest, correlate_valid_rejects_bigger_template)
+{
+    ASSERT_THROW(correlation::correlate(generate(4), generate(5), mode::valid), std::runtime_error);
+}
+
+TEST(CorrelationTest, correlate_2d_all_modes)
+{
+    for (auto width : {5u, 8u})
+    {
+        for (auto height : {3u, 9u})
+        {
+            for (auto pattern_width : {1u, 2u, 5u})
+            {
+                for (auto pattern_height : {2u, 3u})
+                {
+                    auto signal = generate(width * height);
+                    auto pattern = generate(pattern_width * pattern_height);
+                    for (auto output_mode : {mode::full, mode::same, mode::valid})
+                    {
+                        auto expected = naive_correlate_2d(
+                            signal, width, pattern, pattern_width, output_mode);
+                        auto result = correlation::correlate_2d(
+                            signal, width, pattern, pattern_width, output_mode);
+                        ASSERT_NO_FATAL_FAILURE(equal(expected, result))
+                            << "sizes: " << height << "x" << width << " and "
+                            << pattern_height << "x" << pattern_width;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(CorrelationTest, autocorrelate_matches_correlation_with_itself)
+{
+    for (auto size : {1u, 6u, 31u, 64u})
+    {
+        auto signal = generate(size);
+        for (auto output_mode : {mode::full, mode::same, mode::valid})
+        {
+            auto expected = naive_correlate_2d(signal, size, signal, size, output_mode);
+            auto result = correlation::autocorrelate(signal, output_mode);
+            ASSERT_NO_FATAL_FAILURE(equal(expected, result)) << "size " << size;
+        }
+    }
+
+    auto matrix = generate(6 * 7);
+    auto expected = naive_correlate_2d(matrix, 6, matrix, 6, mode::full);
+    ASSERT_NO_FATAL_FAILURE(equal(expected, correlation::autocorrelate_2d(matrix, 6)));
+}
+
+TEST(CorrelationTest, normalized_correlate_vs_naive)
+{
+    auto signal = generate(50);
+    auto pattern = generate(7);
+    for (auto output_mode : {mode::full, mode::same, mode::valid})
+    {
+        auto expected = naive_correlate_2d(signal, 50, pattern, 7, output_mode, true);
+        auto result = correlation::normalized_correlate(signal, pattern, output_mode);
+        ASSERT_NO_FATAL_FAILURE(near(expected, result, 1.0e-9));
+    }
+
+    auto matrix = generate(12 * 10);
+    auto kernel = generate(3 * 4);
+    auto expected = naive_correlate_2d(matrix, 12, kernel, 4, mode::same, true);
+    auto result = correlation::normalized_correlate_2d(matrix, 12, kernel, 4, mode::same);
+    ASSERT_NO_FATAL_FAILURE(near(expected, result, 1.0e-9));
+}
+
+TEST(CorrelationTest, normalized_correlate_finds_scaled_template)
+{
+    auto signal = generate(200);
+    std::vector<double> pattern(signal.begin() + 120, signal.begin() + 140);
+    for (auto& value : pattern) value = 3.0 * value - 7.0;
+
+    auto result = correlation::normalized_correlate(signal, pattern, mode::valid);
+    auto best = std::max_element(result.begin(), result.end());
+    ASSERT_EQ(120, best - result.begin());
+    ASSERT_NEAR(1.0, *best, 1.0e-12);
+}
+
+TEST(CorrelationTest, correlator_reuses_signal_for_many_templates)
+{
+    auto signal = generate(16 * 12);
+    correlation::correlator<double> prepared(signal, 16, 5, 4);
+    for (auto pattern_width : {1u, 3u, 5u})
+    {
+        for (auto pattern_height : {1u, 4u})
+        {
+            auto pattern = generate(pattern_width * pattern_height);
+            for (auto output_mode : {mode::full, mode::same, mode::valid})
+            {
+                auto expected = correlation::correlate_2d(
+                    signal, 16, pattern, pattern_width, output_mode);
+                auto result = prepared.correlate(pattern, pattern_width, output_mode);
+                ASSERT_NO_FATAL_FAILURE(near(expected, result, 1.0e-9));
+            }
+        }
+    }
+    ASSERT_THROW(prepared.correlate(generate(6), 6), std::runtime_error);
+    ASSERT_THROW(correlation::correlator<double>(signal, 0, 5, 4), std::runtime_error);
+    ASSERT_THROW(correlation::correlator<double>(std::vector<double>(), 5), std::runtime_error);
+}
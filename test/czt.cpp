@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "czt.hpp"
+#include "fft.hpp"
+#include "dft.hpp"
+#include "generator.hpp"
+
+namespace
+{
+
+//sum of x[n] z^-n at z = a w^-k
+fft::ComplexVec<double> direct(const fft::ComplexVec<double>& input, size_t count,
+                               std::complex<long double> w, std::complex<long double> a)
+{
+    fft::ComplexVec<double> ret;
+    for (auto k = 0u; k < count; ++k)
+    {
+        auto z = a * std::pow(w, -(long double)(k));
+        std::complex<long double> sum = 0, power = 1;
+        for (auto n = 0u; n < input.size(); ++n)
+        {
+            sum += (std::complex<long double>)input[n] * power;
+            power /= z;
+        }
+        ret.emplace_back(double(sum.real()), double(sum.imag()));
+    }
+    return ret;
+}
+
+} //namespace
+
+TEST(ChirpZTest, check_dft_of_any_size)
+{
+    for (auto size : {1u, 7u, 100u, 128u})
+    {
+        auto vals = dft::real2complex(generate(size));
+        auto w = std::polar(1.0, -2 * M_PI / size);
+        auto result = czt::plan<double>(size, size, w).execute(vals);
+        auto expected = dft::dft(vals);
+        for (auto k = 0u; k < size; ++k)
+            ASSERT_NEAR(0.0, std::abs(expected[k] - result[k]), 1.0e-9 * size) << size << " " << k;
+    }
+}
+
+TEST(ChirpZTest, check_spiral_contour)
+{
+    auto vals = dft::real2complex(generate(50, -1.0, 1.0));
+    std::complex<double> w = std::polar(0.995, -0.05), a = std::polar(0.9, 0.3);
+    czt::plan<double> transform(vals.size(), 79, w, a);
+    ASSERT_EQ(128u, transform.fft_size());
+    auto result = transform.execute(vals);
+    auto expected = direct(vals, 79, w, a);
+    for (auto k = 0u; k < 79; ++k)
+        ASSERT_NEAR(0.0, std::abs(expected[k] - result[k]), 1.0e-9 * std::abs(expected[k]) + 1.0e-9) << k;
+}
+
+TEST(ChirpZTest, check_zoom_on_narrow_band)
+{
+    //two tones two bins apart, evaluated on a grid 25 times finer than the dft's
+    auto size = 1000u;
+    fft::ComplexVec<float> tones(size);
+    for (auto n = 0u; n < size; ++n)
+        tones[n] = std::polar(1.0f, float(2 * M_PI * 0.1 * n)) + std::polar(0.5f, float(2 * M_PI * 0.102 * n));
+    auto transform = czt::plan<float>::zoom(size, 101, 0.099, 0.103);
+    auto result = transform.execute(tones);
+
+    fft::ComplexVec<double> input(tones.begin(), tones.end());
+    auto expected = direct(input, 101, std::polar(1.0L, -2 * M_PIl * 0.004L / 100), std::polar(1.0L, 2 * M_PIl * 0.099L));
+    for (auto k = 0u; k < 101; ++k)
+        ASSERT_NEAR(0.0, std::abs(expected[k] - std::complex<double>(result[k])), 0.5) << k;
+    ASSERT_NEAR(1000.0, std::abs(result[25]), 0.5);
+    ASSERT_NEAR(500.0, std::abs(result[75]), 0.5);
+
+    auto same = czt::zoom_fft(tones, 101, 0.099, 0.103);
+    ASSERT_EQ(result, same);
+}
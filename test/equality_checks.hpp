@@ -14,6 +14,16 @@ inline void equal(const IndexableContainer& expected,
         ASSERT_FLOAT_EQ(expected[i], result[i]) << "elem of index: " << i;
 }
 
+template <typename IndexableContainer>
+inline void near(const IndexableContainer& expected,
+                 const IndexableContainer& result,
+                 double tolerance)
+{
+    ASSERT_EQ(expected.size(), result.size());
+    for (auto i = 0u; i < expected.size(); ++i)
+        ASSERT_NEAR(expected[i], result[i], tolerance) << "elem of index: " << i;
+}
+
 template <typename T>
 inline void equal(const std::vector<std::complex<T>>& expected,
                   const std::vector<std::complex<T>>& result)
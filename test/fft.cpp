@@ -3,6 +3,8 @@
 #include "fft.hpp"
 #include "generator.hpp"
 #include "equality_checks.hpp"
+#include <cmath>
+#include <limits>
 
 struct FFTTest : ::testing::Test {};
 
@@ -81,3 +83,125 @@ TEST_F(FFTTest, check_fft_2d_vs_dft_rectangle_matrix)
     }
 }
 
+
+namespace
+{
+
+//relative RMS error of a float transform against the same transform in double
+template <typename Transform>
+double float_error(size_t size, Transform transform)
+{
+    auto vals = generate(size);
+    fft::ComplexVec<float> input(size);
+    fft::ComplexVec<double> rounded(size);
+    for (auto i = 0u; i < size; ++i)
+    {
+        input[i] = std::complex<float>(float(vals[i]), 0.0f);
+        rounded[i] = std::complex<double>(input[i].real(), 0.0);
+    }
+    auto result = transform(input);
+    auto expected = transform(rounded);
+
+    double error_energy = 0, energy = 0;
+    for (auto i = 0u; i < size; ++i)
+    {
+        auto converted = std::complex<double>(result[i].real(), result[i].imag());
+        error_energy += std::norm(converted - expected[i]);
+        energy += std::norm(expected[i]);
+    }
+    return std::sqrt(error_energy / energy);
+}
+
+struct forward
+{
+    template <typename T>
+    fft::ComplexVec<T> operator()(const fft::ComplexVec<T>& arg) const
+    {
+        return fft::fft(arg);
+    }
+};
+
+struct inverse
+{
+    template <typename T>
+    fft::ComplexVec<T> operator()(const fft::ComplexVec<T>& arg) const
+    {
+        return fft::inv_fft(arg);
+    }
+};
+
+} //namespace
+
+TEST_F(FFTTest, check_float_fft_within_float_error_bound)
+{
+    for (auto size = 2u; size <= (1u << 16); size *= 2)
+    {
+        auto bound = 0.5 * std::numeric_limits<float>::epsilon() * std::log2(double(size));
+        ASSERT_LE(float_error(size, forward()), bound) << " for size of " << size;
+        ASSERT_LE(float_error(size, inverse()), bound) << " for size of " << size;
+    }
+}
+
+TEST_F(FFTTest, check_float_fft_with_inverse_finishes_the_same)
+{
+    auto vals = generate(1024);
+    fft::ComplexVec<float> input(vals.size());
+    for (auto i = 0u; i < vals.size(); ++i)
+        input[i] = std::complex<float>(float(vals[i]), 0.0f);
+    auto converted = fft::inv_fft(fft::fft(input));
+    for (auto i = 0u; i < vals.size(); ++i)
+        ASSERT_NEAR(input[i].real(), converted[i].real(), 1.0e-4) << "elem of index: " << i;
+}
+
+TEST_F(FFTTest, check_input_pruned_fft_vs_padded_fft)
+{
+    for (auto count : {0u, 1u, 5u, 64u, 100u, 256u})
+    {
+        auto vals = dft::real2complex(generate(count));
+        auto padded = vals;
+        padded.resize(256);
+        auto expected = fft::fft(padded);
+        auto result = fft::fft_input_pruned(vals, 256);
+        auto inverse_expected = fft::inv_fft(padded);
+        auto inverse_result = fft::inv_fft_input_pruned(vals, 256);
+        ASSERT_EQ(256u, result.size());
+        for (auto k = 0u; k < 256; ++k)
+        {
+            ASSERT_NEAR(0.0, std::abs(expected[k] - result[k]), 1.0e-9) << count << " " << k;
+            ASSERT_NEAR(0.0, std::abs(inverse_expected[k] - inverse_result[k]), 1.0e-11) << count << " " << k;
+        }
+    }
+}
+
+TEST_F(FFTTest, check_output_pruned_fft_vs_fft)
+{
+    auto vals = dft::real2complex(generate(512));
+    auto expected = fft::fft(vals);
+    auto inverse_expected = fft::inv_fft(vals);
+    //bands inside, across the end and covering the whole spectrum
+    for (auto band : {std::make_pair(0u, 1u), std::make_pair(37u, 20u), std::make_pair(500u, 30u),
+                      std::make_pair(100u, 256u), std::make_pair(3u, 512u)})
+    {
+        auto result = fft::fft_output_pruned(vals, band.first, band.second);
+        auto inverse_result = fft::inv_fft_output_pruned(vals, band.first, band.second);
+        ASSERT_EQ(band.second, result.size());
+        for (auto j = 0u; j < band.second; ++j)
+        {
+            auto k = (band.first + j) % 512;
+            ASSERT_NEAR(0.0, std::abs(expected[k] - result[j]), 1.0e-9) << band.first << " " << j;
+            ASSERT_NEAR(0.0, std::abs(inverse_expected[k] - inverse_result[j]), 1.0e-11) << band.first << " " << j;
+        }
+    }
+}
+
+TEST_F(FFTTest, check_plans_above_the_cache_limit_are_kept)
+{
+    auto size = fft::impl::cached_plan_max_size * 2;
+    std::shared_ptr<const fft::plan<float>> first, second, other;
+    auto& plan = fft::impl::plan_for<float>(size, first);
+    ASSERT_EQ(&plan, &fft::impl::plan_for<float>(size, second));
+    //another big size replaces it on this thread, the handles keep it alive
+    ASSERT_EQ(2 * size, fft::impl::plan_for<float>(2 * size, other).size());
+    ASSERT_EQ(size, plan.size());
+    ASSERT_EQ(size, plan.permutation().size());
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "fixed.hpp"
+#include "fft.hpp"
+#include "generator.hpp"
+#include <cmath>
+
+namespace
+{
+
+template <typename T>
+fixed::ComplexVec<T> samples(size_t size, double amplitude)
+{
+    auto re = generate(size, -amplitude, amplitude);
+    auto im = generate(size, -amplitude, amplitude);
+    fixed::ComplexVec<T> ret(size);
+    for (auto i = 0u; i < size; ++i)
+        ret[i] = fixed::complex<T>(T(std::lround(re[i])), T(std::lround(im[i])));
+    return ret;
+}
+
+template <typename T>
+fft::ComplexVec<double> to_double(const fixed::ComplexVec<T>& arg)
+{
+    return fixed::to_double(fixed::spectrum<T>{arg, 0});
+}
+
+//RMS difference relative to the RMS of the expected values
+double error(const fft::ComplexVec<double>& expected, const fft::ComplexVec<double>& result)
+{
+    double error_energy = 0, energy = 0;
+    for (auto i = 0u; i < expected.size(); ++i)
+    {
+        error_energy += std::norm(result[i] - expected[i]);
+        energy += std::norm(expected[i]);
+    }
+    return std::sqrt(error_energy / energy);
+}
+
+} //namespace
+
+TEST(FixedTest, check_int16_fft_vs_double)
+{
+    for (auto size = 2u; size <= 8192u; size *= 2)
+    {
+        auto input = samples<int16_t>(size, 32767.0);
+        auto expected = fft::fft(to_double(input));
+        auto result = fixed::fft(input);
+        ASSERT_LE(error(expected, fixed::to_double(result)), 1.0e-3 * std::log2(double(size)))
+            << " for size of " << size;
+    }
+}
+
+TEST(FixedTest, check_int32_fft_vs_double)
+{
+    for (auto size = 2u; size <= 8192u; size *= 2)
+    {
+        auto input = samples<int32_t>(size, 2147483647.0);
+        auto expected = fft::fft(to_double(input));
+        auto result = fixed::fft(input);
+        ASSERT_LE(error(expected, fixed::to_double(result)), 1.0e-7 * std::log2(double(size)))
+            << " for size of " << size;
+    }
+}
+
+TEST(FixedTest, check_exponent_follows_the_growth)
+{
+    auto quiet = fixed::fft(samples<int16_t>(16, 100.0));
+    ASSERT_EQ(0, quiet.exponent);
+
+    //a full scale constant sums up to 1024 times the range of int16_t
+    std::vector<int16_t> constant(1024, -32768);
+    auto loud = fixed::fft(constant);
+    ASSERT_GE(loud.exponent, 10);
+    auto result = fixed::to_double(loud);
+    ASSERT_NEAR(-32768.0 * 1024, result[0].real(), 32768.0);
+    for (auto i = 1u; i < result.size(); ++i)
+        ASSERT_NEAR(0.0, std::abs(result[i]), 1.0e-6) << "elem of index: " << i;
+}
+
+TEST(FixedTest, check_fft_with_inverse_finishes_the_same)
+{
+    for (auto size : {1u, 4u, 64u, 2048u})
+    {
+        auto input = samples<int16_t>(size, 20000.0);
+        auto restored = fixed::to_double(fixed::inv_fft(fixed::fft(input)));
+        ASSERT_LE(error(to_double(input), restored), 2.0e-3) << " for size of " << size;
+    }
+}
+
+TEST(FixedTest, check_real_samples_and_invalid_size)
+{
+    std::vector<int32_t> input = {1000, 0, -1000, 0};
+    auto result = fixed::to_double(fixed::fft(input));
+    ASSERT_NEAR(0.0, std::abs(result[0]), 1.0e-9);
+    ASSERT_NEAR(2000.0, result[1].real(), 1.0e-6);
+    ASSERT_NEAR(2000.0, result[3].real(), 1.0e-6);
+    ASSERT_THROW(fixed::fft(std::vector<int16_t>(12, 1)), std::runtime_error);
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include "goertzel.hpp"
+#include "fft.hpp"
+#include "dft.hpp"
+#include "generator.hpp"
+
+namespace
+{
+
+std::complex<double> reference(const std::vector<double>& vals, double bin)
+{
+    auto re = 0.0L, im = 0.0L;
+    for (auto n = 0u; n < vals.size(); ++n)
+    {
+        auto angle = -2 * 3.141592653589793238462643383279502884L * bin * n / vals.size();
+        re += vals[n] * std::cos(angle);
+        im += vals[n] * std::sin(angle);
+    }
+    return std::complex<double>(double(re), double(im));
+}
+
+} //namespace
+
+TEST(GoertzelTest, check_integer_and_fractional_bins)
+{
+    auto vals = generate(1000);
+    //more bins than a wide group, so both group widths run
+    std::vector<double> bins;
+    for (auto i = 0u; i < 45; ++i)
+        bins.push_back(i * 11.3);
+    bins.push_back(0.0);
+    bins.push_back(500.0);
+    goertzel::plan<double> evaluator(vals.size(), bins);
+    auto result = evaluator.execute(vals);
+    ASSERT_EQ(bins.size(), result.size());
+    for (auto j = 0u; j < bins.size(); ++j)
+    {
+        auto expected = reference(vals, bins[j]);
+        ASSERT_NEAR(expected.real(), result[j].real(), 1.0e-7) << bins[j];
+        ASSERT_NEAR(expected.imag(), result[j].imag(), 1.0e-7) << bins[j];
+    }
+}
+
+TEST(GoertzelTest, check_cost_heuristic_and_dispatch)
+{
+    ASSERT_EQ(goertzel::method::goertzel, goertzel::cheaper<float>(4096, 5));
+    ASSERT_EQ(goertzel::method::goertzel, goertzel::cheaper<float>(4096, 20));
+    ASSERT_EQ(goertzel::method::goertzel, goertzel::cheaper<double>(4096, 8));
+    ASSERT_EQ(goertzel::method::fft, goertzel::cheaper<double>(4096, 20));
+    ASSERT_EQ(goertzel::method::fft, goertzel::cheaper<float>(4096, 100));
+
+    auto vals = generate(256);
+    auto spectrum = fft::fft(dft::real2complex(vals));
+    for (auto count : {3u, 40u})
+    {
+        std::vector<double> bins;
+        for (auto i = 0u; i < count; ++i)
+            bins.push_back((i * 37) % 256);
+        auto result = goertzel::evaluate(vals, bins);
+        for (auto j = 0u; j < count; ++j)
+            ASSERT_NEAR(0.0, std::abs(spectrum[size_t(bins[j])] - result[j]), 1.0e-8) << bins[j];
+    }
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "half.hpp"
+#include "dft.hpp"
+#include "fft.hpp"
+#include "generator.hpp"
+#include <cmath>
+#include <limits>
+
+using half::float16;
+using half::bfloat16;
+
+namespace
+{
+
+template <typename Storage>
+half::ComplexVec<Storage> to_storage(const std::vector<double>& vals)
+{
+    half::ComplexVec<Storage> ret(vals.size());
+    for (auto i = 0u; i < vals.size(); ++i)
+        ret[i] = half::complex<Storage>(Storage(float(vals[i])), Storage(0.0f));
+    return ret;
+}
+
+//the stored input, exactly as the transform sees it
+template <typename Storage>
+fft::ComplexVec<double> to_double(const half::ComplexVec<Storage>& vals)
+{
+    fft::ComplexVec<double> ret(vals.size());
+    for (auto i = 0u; i < vals.size(); ++i)
+        ret[i] = std::complex<double>(float(vals[i].re), float(vals[i].im));
+    return ret;
+}
+
+//relative RMS difference
+template <typename Storage>
+double error(const fft::ComplexVec<double>& expected, const half::ComplexVec<Storage>& result)
+{
+    auto converted = to_double(result);
+    double error_energy = 0, energy = 0;
+    for (auto i = 0u; i < expected.size(); ++i)
+    {
+        error_energy += std::norm(converted[i] - expected[i]);
+        energy += std::norm(expected[i]);
+    }
+    return std::sqrt(error_energy / energy);
+}
+
+} //namespace
+
+TEST(HalfTest, check_float16_round_trips_every_value)
+{
+    for (auto bits = 0u; bits < (1u << 16); ++bits)
+    {
+        auto value = float(float16::from_bits(uint16_t(bits)));
+        if (std::isnan(value))
+            ASSERT_TRUE(std::isnan(float(float16(value)))) << "bits " << bits;
+        else
+            ASSERT_EQ(bits, float16(value).bits) << "bits " << bits;
+    }
+}
+
+TEST(HalfTest, check_float16_rounding)
+{
+    ASSERT_EQ(1.0f, float(float16(1.0f + 0.00048828125f)));
+    ASSERT_EQ(1.0f + 0.001953125f, float(float16(1.0f + 0.00146484375f)));
+    ASSERT_EQ(65504.0f, float(float16(65519.0f)));
+    ASSERT_TRUE(std::isinf(float(float16(65520.0f))));
+    ASSERT_EQ(0.0f, float(float16(std::ldexp(1.0f, -25))));
+    ASSERT_EQ(std::ldexp(1.0f, -24), float(float16(std::ldexp(1.5f, -25))));
+    ASSERT_EQ(-2.0f, float(float16(-2.0f)));
+}
+
+TEST(HalfTest, check_bfloat16_rounding)
+{
+    ASSERT_EQ(1.0f, float(bfloat16(1.0f + std::ldexp(1.0f, -8))));
+    ASSERT_EQ(1.0f + std::ldexp(1.0f, -6), float(bfloat16(1.0f + std::ldexp(3.0f, -8))));
+    ASSERT_NEAR(-3.0e38f, float(bfloat16(-3.0e38f)), 3.0e38f / 256);
+    ASSERT_TRUE(std::isnan(float(bfloat16(std::numeric_limits<float>::quiet_NaN()))));
+    ASSERT_TRUE(std::isinf(float(bfloat16(std::numeric_limits<float>::infinity()))));
+}
+
+TEST(HalfTest, check_fft_within_storage_precision)
+{
+    for (auto size = 2u; size <= 4096u; size *= 4)
+    {
+        auto vals = generate(size, -1.0, 1.0);
+        auto stored16 = to_storage<float16>(vals);
+        auto storedb16 = to_storage<bfloat16>(vals);
+        ASSERT_LE(error(fft::fft(to_double(stored16)), half::fft(stored16)), 1.0e-3) << size;
+        ASSERT_LE(error(fft::fft(to_double(storedb16)), half::fft(storedb16)), 8.0e-3) << size;
+        ASSERT_LE(error(fft::inv_fft(to_double(stored16)), half::inv_fft(stored16)), 1.0e-3) << size;
+    }
+}
+
+TEST(HalfTest, check_fft_with_inverse_finishes_the_same)
+{
+    auto vals = to_storage<float16>(generate(256, -1.0, 1.0));
+    auto converted = half::inv_fft(half::fft(vals));
+    ASSERT_LE(error(to_double(vals), converted), 2.0e-3);
+}
+
+TEST(HalfTest, check_batch_matches_single_transforms)
+{
+    auto length = 64u;
+    auto vals = to_storage<bfloat16>(generate(length * 5, -1.0, 1.0));
+    auto result = half::fft_batch(vals, length, 3);
+    for (auto row = 0u; row < 5; ++row)
+    {
+        half::ComplexVec<bfloat16> single(vals.begin() + row * length, vals.begin() + (row + 1) * length);
+        single = half::fft(single);
+        for (auto i = 0u; i < length; ++i)
+        {
+            ASSERT_EQ(single[i].re.bits, result[row * length + i].re.bits);
+            ASSERT_EQ(single[i].im.bits, result[row * length + i].im.bits);
+        }
+    }
+    ASSERT_THROW(half::fft_batch(vals, 100), std::runtime_error);
+}
+
+TEST(HalfTest, check_fft_2d_vs_double)
+{
+    for (auto width : {1u, 4u, 32u})
+    {
+        for (auto height : {1u, 8u, 16u})
+        {
+            auto vals = to_storage<float16>(generate(width * height, -1.0, 1.0));
+            auto expected = fft::fft_2d(to_double(vals), width);
+            ASSERT_LE(error(expected, half::fft_2d(vals, width, 2)), 2.0e-3)
+                << "width " << width << " and height " << height;
+            auto restored = half::inv_fft_2d(half::fft_2d(vals, width), width);
+            ASSERT_LE(error(to_double(vals), restored), 4.0e-3)
+                << "width " << width << " and height " << height;
+        }
+    }
+}
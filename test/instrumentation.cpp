@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include "instrumentation.hpp"
+#include "convolution.hpp"
+#include "generator.hpp"
+#include <sstream>
+
+//built into the test binary without instrumentation and into instrumentation_test with it
+
+using instrumentation::counter;
+using instrumentation::stage;
+
+TEST(InstrumentationTest, counts_plans_and_transforms_by_size)
+{
+    instrumentation::reset();
+    fft::inv_fft(fft::fft(dft::real2complex(generate(64))));
+    fft::fft(dft::real2complex(generate(16)));
+    auto snapshot = instrumentation::take_snapshot();
+
+    if (not instrumentation::enabled())
+    {
+        ASSERT_EQ(0u, snapshot[counter::plans_created]);
+        ASSERT_EQ(0u, snapshot[stage::butterflies].calls);
+        ASSERT_TRUE(snapshot.transforms_by_size.empty());
+        return;
+    }
+    //plans are cached per thread, so earlier tests may have created some of them
+    ASSERT_EQ(3u, snapshot[counter::plans_created] + snapshot[counter::plan_cache_hits]);
+    ASSERT_LE(snapshot[counter::plans_created], 2u);
+    ASSERT_EQ(snapshot[counter::plans_created], snapshot[counter::twiddle_tables_computed]);
+    //the permutation and both twiddle tables, recorded by the allocator
+    ASSERT_EQ(3 * snapshot[counter::plans_created], snapshot[counter::allocations]);
+    ASSERT_EQ(3u, snapshot[stage::butterflies].calls);
+    ASSERT_EQ(1u, snapshot[stage::scaling].calls);
+    ASSERT_EQ(2u, snapshot.transforms_by_size[64]);
+    ASSERT_EQ(1u, snapshot.transforms_by_size[16]);
+}
+
+TEST(InstrumentationTest, counts_transposes_and_spectrum_cache)
+{
+    instrumentation::reset();
+    fft::fft_2d(dft::real2complex(generate(8 * 4)), 8);
+    convolution::filter<double> prepared(generate(5));
+    for (auto i = 0; i < 3; ++i)
+        prepared(generate(20));
+    auto snapshot = instrumentation::take_snapshot();
+
+    std::stringstream dump;
+    dump << snapshot;
+    if (not instrumentation::enabled())
+    {
+        ASSERT_EQ(0u, snapshot[stage::transpose].calls);
+        ASSERT_EQ(0u, snapshot[counter::spectrum_cache_hits]);
+        return;
+    }
+    ASSERT_EQ(2u, snapshot[stage::transpose].calls);
+    ASSERT_EQ(1u, snapshot[counter::spectrum_cache_misses]);
+    ASSERT_EQ(2u, snapshot[counter::spectrum_cache_hits]);
+    ASSERT_EQ(3u, snapshot[stage::spectral_product].calls);
+    ASSERT_NE(std::string::npos, dump.str().find("spectrum_cache_hits: 2"));
+    ASSERT_NE(std::string::npos, dump.str().find("transforms of size 32: 7"));
+}
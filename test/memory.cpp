@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "memory.hpp"
+#include "fft.hpp"
+#include "dft.hpp"
+#include "generator.hpp"
+#include "equality_checks.hpp"
+#include <cstdint>
+
+TEST(MemoryTest, check_aligned_allocator)
+{
+    for (auto size : {1u, 3u, 100u, 4097u})
+    {
+        memory::aligned_vector<std::complex<float>> values(size);
+        ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(values.data()) % memory::cache_line);
+        std::vector<double, memory::aligned_allocator<double, 4096>> page(size);
+        ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(page.data()) % 4096);
+    }
+}
+
+TEST(MemoryTest, check_pool_reuses_released_workspaces)
+{
+    memory::workspace_pool pool;
+    {
+        memory::workspace<double> first(100, pool);
+        memory::workspace<double> second(100, pool);
+        ASSERT_NE(first.data(), second.data());
+        ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(first.data()) % memory::cache_line);
+        ASSERT_EQ(2048u, pool.statistics().bytes_in_use);
+        ASSERT_EQ(2048u, pool.statistics().peak_bytes_in_use);
+    }
+    ASSERT_EQ(0u, pool.statistics().bytes_in_use);
+    ASSERT_EQ(2u, pool.statistics().allocations);
+
+    {
+        //the same size class is served from the released blocks
+        memory::workspace<double> again(120, pool);
+        memory::workspace<double> moved(std::move(again));
+        ASSERT_EQ(1u, pool.statistics().reuses);
+    }
+    ASSERT_EQ(3u, pool.statistics().acquisitions);
+    ASSERT_EQ(2u, pool.statistics().allocations);
+    ASSERT_EQ(2048u, pool.statistics().bytes_reserved);
+
+    pool.trim();
+    ASSERT_EQ(0u, pool.statistics().bytes_reserved);
+}
+
+TEST(MemoryTest, check_repeated_fft_2d_does_not_allocate_workspaces)
+{
+    auto vals = dft::real2complex(generate(32 * 16));
+    auto expected = fft::fft_2d(vals, 32);
+    auto allocations = memory::thread_pool().statistics().allocations;
+    for (auto i = 0; i < 3; ++i)
+        ASSERT_NO_FATAL_FAILURE(equal(expected, fft::fft_2d(vals, 32)));
+    ASSERT_EQ(allocations, memory::thread_pool().statistics().allocations);
+    ASSERT_EQ(0u, memory::thread_pool().statistics().bytes_in_use);
+}
+
+TEST(MemoryTest, check_huge_page_buffers_with_every_policy)
+{
+    auto previous = memory::current_page_policy();
+    for (auto policy : {memory::page_policy::normal, memory::page_policy::transparent,
+                        memory::page_policy::explicit_huge})
+    {
+        //without reserved huge pages explicit_huge falls back to the others
+        memory::huge_vector<std::complex<float>> large(
+            (3 * memory::huge_page_size) / sizeof(std::complex<float>),
+            std::complex<float>(1.0f, 0.0f), memory::huge_page_allocator<std::complex<float>>(policy));
+        ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(large.data()) % memory::huge_page_size);
+        ASSERT_EQ(1.0f, large.back().real());
+
+        memory::huge_vector<double> small(10, 0.0, memory::huge_page_allocator<double>(policy));
+        ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(small.data()) % memory::cache_line);
+
+        memory::set_page_policy(policy);
+        memory::workspace_pool pool;
+        memory::workspace<double> scratch(memory::huge_page_size / sizeof(double) + 1, pool);
+        ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(scratch.data()) % memory::huge_page_size);
+        scratch[scratch.size() - 1] = 1.0;
+    }
+    memory::set_page_policy(previous);
+}
+
+TEST(MemoryTest, check_fft_2d_in_place_vs_fft_2d)
+{
+    auto width = 64u, height = 32u;
+    auto vals = dft::real2complex(generate(width * height));
+    memory::huge_vector<std::complex<double>> data(vals.begin(), vals.end());
+    fft::fft_2d_in_place(data.data(), width, height);
+    auto expected = fft::fft_2d(vals, width);
+    ASSERT_NO_FATAL_FAILURE(equal(expected, fft::ComplexVec<double>(data.begin(), data.end())));
+    fft::inv_fft_2d_in_place(data.data(), width, height);
+    for (auto i = 0u; i < vals.size(); ++i)
+        ASSERT_NEAR(vals[i].real(), data[i].real(), 1.0e-9);
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "ntt.hpp"
+#include <random>
+
+template <typename T>
+std::vector<T> random_values(size_t size, T from, T to)
+{
+    static std::mt19937_64 rd;
+    std::uniform_int_distribution<T> dist(from, to);
+    std::vector<T> ret(size);
+    for (auto& elem : ret) elem = dist(rd);
+    return ret;
+}
+
+TEST(NttTest, montgomery_arithmetic_matches_modular_arithmetic)
+{
+    for (auto modulus : {998244353u, 754974721u, 17u})
+    {
+        ntt::montgomery arithmetic(modulus);
+        auto values = random_values<uint32_t>(200, 0, modulus - 1);
+        for (auto i = 0u; i + 1 < values.size(); ++i)
+        {
+            uint64_t a = values[i], b = values[i + 1];
+            auto first = arithmetic.to(values[i]);
+            auto second = arithmetic.to(values[i + 1]);
+            ASSERT_EQ(a, arithmetic.from(first));
+            ASSERT_EQ(a * b % modulus, arithmetic.from(arithmetic.multiply(first, second)));
+            ASSERT_EQ((a + b) % modulus, arithmetic.from(arithmetic.add(first, second)));
+            ASSERT_EQ((a + modulus - b) % modulus, arithmetic.from(arithmetic.subtract(first, second)));
+        }
+    }
+    ASSERT_THROW(ntt::montgomery(1u << 20), std::runtime_error);
+}
+
+TEST(NttTest, transform_matches_naive_and_inverts)
+{
+    auto modulus = ntt::default_prime.modulus;
+    for (auto size : {1u, 2u, 8u, 64u})
+    {
+        ntt::plan transform(size);
+        auto& arithmetic = transform.arithmetic();
+        auto values = random_values<uint32_t>(size, 0, modulus - 1);
+
+        std::vector<uint32_t> data;
+        for (auto value : values) data.push_back(arithmetic.to(value));
+        transform.execute(data.data(), false);
+
+        auto root = arithmetic.power(arithmetic.to(ntt::default_prime.generator), (modulus - 1) / size);
+        for (auto k = 0u; k < size; ++k)
+        {
+            auto expected = arithmetic.to(0);
+            for (auto n = 0u; n < size; ++n)
+                expected = arithmetic.add(expected, arithmetic.multiply(
+                    arithmetic.to(values[n]), arithmetic.power(root, uint64_t(n) * k)));
+            ASSERT_EQ(arithmetic.from(expected), arithmetic.from(data[k])) << "size " << size;
+        }
+
+        transform.execute(data.data(), true);
+        for (auto i = 0u; i < size; ++i)
+            ASSERT_EQ(values[i], arithmetic.from(data[i]));
+    }
+    ASSERT_THROW(ntt::plan(12), std::runtime_error);
+    ASSERT_THROW(ntt::plan(1u << 24), std::runtime_error);
+}
+
+TEST(NttTest, modular_convolution_vs_naive)
+{
+    auto modulus = ntt::default_prime.modulus;
+    for (auto sizes : {std::make_pair(1u, 1u), std::make_pair(5u, 3u), std::make_pair(100u, 37u)})
+    {
+        auto first = random_values<uint32_t>(sizes.first, 0, modulus - 1);
+        auto second = random_values<uint32_t>(sizes.second, 0, modulus - 1);
+        std::vector<uint64_t> expected(first.size() + second.size() - 1, 0);
+        for (auto i = 0u; i < first.size(); ++i)
+            for (auto j = 0u; j < second.size(); ++j)
+                expected[i + j] = (expected[i + j] + uint64_t(first[i]) * second[j]) % modulus;
+
+        auto result = ntt::convolve(first, second);
+        ASSERT_EQ(expected.size(), result.size());
+        for (auto i = 0u; i < expected.size(); ++i)
+            ASSERT_EQ(expected[i], result[i]) << "index " << i;
+    }
+}
+
+TEST(NttTest, exact_convolution_of_large_coefficients)
+{
+    auto first = random_values<int64_t>(3000, -(int64_t(1) << 40), int64_t(1) << 40);
+    auto second = random_values<int64_t>(1000, -(int64_t(1) << 10), int64_t(1) << 10);
+    std::vector<int64_t> expected(first.size() + second.size() - 1, 0);
+    for (auto i = 0u; i < first.size(); ++i)
+        for (auto j = 0u; j < second.size(); ++j)
+            expected[i + j] += first[i] * second[j];
+
+    auto result = ntt::convolve_exact(first, second);
+    ASSERT_EQ(expected.size(), result.size());
+    for (auto i = 0u; i < expected.size(); ++i)
+        ASSERT_EQ(expected[i], result[i]) << "index " << i;
+
+    ASSERT_THROW(ntt::convolve_exact(std::vector<int64_t>(4, int64_t(1) << 31),
+                                     std::vector<int64_t>(4, int64_t(1) << 31)),
+                 std::overflow_error);
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "nufft.hpp"
+#include "generator.hpp"
+
+namespace
+{
+
+std::vector<double> points(size_t count)
+{
+    //also outside [-pi, pi), the transforms are periodic
+    return generate(count, -3 * M_PI, 3 * M_PI);
+}
+
+fft::ComplexVec<double> values(size_t count)
+{
+    auto re = generate(count, -1.0, 1.0), im = generate(count, -1.0, 1.0);
+    fft::ComplexVec<double> ret;
+    for (auto i = 0u; i < count; ++i)
+        ret.emplace_back(re[i], im[i]);
+    return ret;
+}
+
+std::complex<long double> exponential(int sign, long double phase)
+{
+    return std::complex<long double>(std::cos(phase), sign * std::sin(phase));
+}
+
+//relative l2 error
+double error(const fft::ComplexVec<double>& expected, const fft::ComplexVec<double>& result)
+{
+    auto diff = 0.0, norm = 0.0;
+    for (auto i = 0u; i < expected.size(); ++i)
+    {
+        diff += std::norm(expected[i] - result[i]);
+        norm += std::norm(expected[i]);
+    }
+    return std::sqrt(diff / norm);
+}
+
+} //namespace
+
+TEST(NufftTest, check_1d_against_direct_sums)
+{
+    auto x = points(300);
+    auto strengths = values(300);
+    auto coefficients = values(51);
+    for (auto tolerance : {1.0e-6, 1.0e-11})
+        for (auto sign : {-1, 1})
+        {
+            nufft::plan_1d<double> transform(51, tolerance, 3);
+            ASSERT_EQ(128u, transform.grid_size());
+            auto forward = transform.type1(x, strengths, sign);
+            auto backward = transform.type2(x, coefficients, sign);
+
+            fft::ComplexVec<double> expected_forward, expected_backward;
+            for (auto k = -25; k <= 25; ++k)
+            {
+                std::complex<long double> sum;
+                for (auto j = 0u; j < x.size(); ++j)
+                    sum += (std::complex<long double>)strengths[j] * exponential(sign, k * (long double)x[j]);
+                expected_forward.emplace_back(double(sum.real()), double(sum.imag()));
+            }
+            for (auto j = 0u; j < x.size(); ++j)
+            {
+                std::complex<long double> sum;
+                for (auto k = -25; k <= 25; ++k)
+                    sum += (std::complex<long double>)coefficients[k + 25] * exponential(sign, k * (long double)x[j]);
+                expected_backward.emplace_back(double(sum.real()), double(sum.imag()));
+            }
+            ASSERT_LT(error(expected_forward, forward), 10 * tolerance) << tolerance << " " << sign;
+            ASSERT_LT(error(expected_backward, backward), 10 * tolerance) << tolerance << " " << sign;
+        }
+    ASSERT_LT(error(nufft::plan_1d<double>(51).type1(x, strengths), nufft::type1(x, strengths, 51)), 1.0e-15);
+}
+
+TEST(NufftTest, check_2d_against_direct_sums)
+{
+    auto x = points(200), y = points(200);
+    auto strengths = values(200);
+    auto coefficients = values(20 * 13);
+    nufft::plan_2d<double> transform(20, 13, 1.0e-9, 2);
+    ASSERT_EQ(64u, transform.grid_width());
+    ASSERT_EQ(32u, transform.grid_height());
+    auto forward = transform.type1(x, y, strengths);
+    auto backward = transform.type2(x, y, coefficients);
+
+    fft::ComplexVec<double> expected_forward(20 * 13), expected_backward(200);
+    for (auto ky = -6; ky <= 6; ++ky)
+        for (auto kx = -10; kx <= 9; ++kx)
+        {
+            std::complex<long double> sum;
+            for (auto j = 0u; j < x.size(); ++j)
+            {
+                auto phase = kx * (long double)x[j] + ky * (long double)y[j];
+                sum += (std::complex<long double>)strengths[j] * exponential(-1, phase);
+                expected_backward[j] += std::complex<double>(coefficients[(ky + 6) * 20 + kx + 10]
+                                                             * std::complex<double>(exponential(1, phase)));
+            }
+            expected_forward[(ky + 6) * 20 + kx + 10] = std::complex<double>(sum);
+        }
+    ASSERT_LT(error(expected_forward, forward), 1.0e-8);
+    ASSERT_LT(error(expected_backward, backward), 1.0e-8);
+
+    //all points in one thread give the same sums up to rounding
+    auto single = nufft::plan_2d<double>(20, 13, 1.0e-9).type1(x, y, strengths);
+    ASSERT_LT(error(single, forward), 1.0e-13);
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "out_of_core.hpp"
+#include "fft.hpp"
+#include "dft.hpp"
+#include "generator.hpp"
+#include "equality_checks.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sys/stat.h>
+
+namespace
+{
+
+std::string temporary(const std::string& name)
+{
+    return "/tmp/fft_out_of_core_" + std::to_string(::getpid()) + "_" + name;
+}
+
+void save(const std::string& path, const fft::ComplexVec<double>& values)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(values[0]));
+}
+
+fft::ComplexVec<double> load(const std::string& path, size_t size)
+{
+    fft::ComplexVec<double> ret(size);
+    std::ifstream file(path, std::ios::binary);
+    file.read(reinterpret_cast<char*>(ret.data()), size * sizeof(ret[0]));
+    return ret;
+}
+
+} //namespace
+
+TEST(OutOfCoreTest, check_fft_in_two_passes_vs_fft)
+{
+    auto input = temporary("input"), output = temporary("output");
+    for (auto size : {8u, 32u, 1024u, 4096u})
+    {
+        auto vals = dft::real2complex(generate(size));
+        save(input, vals);
+        //room for 64 values only
+        auto result = out_of_core::fft<double>(input, output, 64 * sizeof(vals[0]));
+        ASSERT_EQ(size, result.size);
+        ASSERT_EQ(size, result.rows * result.columns);
+        ASSERT_EQ(size <= 64 ? 1u : 2u, result.passes) << " for size of " << size;
+        ASSERT_NO_FATAL_FAILURE(equal(fft::fft(vals), load(output, size))) << " for size of " << size;
+    }
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+}
+
+TEST(OutOfCoreTest, check_inverse_in_place_finishes_the_same)
+{
+    auto path = temporary("in_place");
+    auto vals = dft::real2complex(generate(2048));
+    save(path, vals);
+    out_of_core::fft<double>(path, path, 1024);
+    auto result = out_of_core::inv_fft<double>(path, path, 1024);
+    ASSERT_EQ(2u, result.passes);
+    ASSERT_EQ(2 * 2048 * sizeof(vals[0]), result.bytes_read);
+    auto restored = load(path, vals.size());
+    for (auto i = 0u; i < vals.size(); ++i)
+        ASSERT_NEAR(vals[i].real(), restored[i].real(), 1.0e-9) << "elem of index: " << i;
+    std::remove(path.c_str());
+}
+
+TEST(OutOfCoreTest, check_invalid_inputs)
+{
+    auto path = temporary("invalid");
+    save(path, dft::real2complex(generate(12)));
+    ASSERT_THROW(out_of_core::fft<double>(path, path, 1 << 20), std::runtime_error);
+    save(path, dft::real2complex(generate(4096)));
+    ASSERT_THROW(out_of_core::fft<double>(path, path, 32 * sizeof(std::complex<double>)),
+                 std::runtime_error);
+    ASSERT_THROW(out_of_core::fft<double>(temporary("missing"), path, 1 << 20), std::runtime_error);
+
+    //a trailing partial value
+    std::ofstream(path, std::ios::binary | std::ios::app) << "xyz";
+    ASSERT_THROW(out_of_core::fft<double>(path, temporary("out"), 1 << 20), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(OutOfCoreTest, check_partial_file_is_removed_on_failure)
+{
+    auto path = temporary("failing");
+    save(path, dft::real2complex(generate(4096)));
+    //a directory as output fails in the second pass, after the partial file is written
+    auto output = temporary("directory");
+    ASSERT_EQ(0, ::mkdir(output.c_str(), 0755));
+    ASSERT_THROW(out_of_core::fft<double>(path, output, 1024 * sizeof(std::complex<double>)),
+                 std::runtime_error);
+    ASSERT_FALSE(std::ifstream(output + ".partial").good());
+    ::rmdir(output.c_str());
+    std::remove(path.c_str());
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include "psd.hpp"
+#include "window.hpp"
+#include "fft.hpp"
+#include "dft.hpp"
+#include "generator.hpp"
+#include <cmath>
+
+TEST(PSDTest, check_welch_vs_averaged_ffts)
+{
+    auto& taper = window::cached<double>(window::shape::hann, 64);
+    auto vals = generate(1000);
+    psd::welch<double> estimator(taper, 32, 128);
+    auto result = estimator.estimate(vals, 10.0);
+    ASSERT_EQ(65u, result.size());
+    ASSERT_EQ(30u, estimator.segments(vals.size()));
+
+    std::vector<double> expected(65, 0.0);
+    auto squares = 0.0;
+    for (auto value : taper) squares += value * value;
+    for (auto s = 0u; s < 30; ++s)
+    {
+        fft::ComplexVec<double> segment(128);
+        for (auto i = 0u; i < 64; ++i)
+            segment[i] = vals[s * 32 + i] * taper[i];
+        auto spectrum = fft::fft(segment);
+        for (auto k = 0u; k < 65; ++k)
+            expected[k] += std::norm(spectrum[k]) * ((k == 0 or k == 64) ? 1.0 : 2.0) / (10.0 * squares * 30);
+    }
+    for (auto k = 0u; k < 65; ++k)
+        ASSERT_NEAR(expected[k], result[k], 1.0e-9 * expected[k]) << k;
+
+    auto threaded = estimator.estimate(vals, 10.0, psd::scaling::density, 4);
+    for (auto k = 0u; k < 65; ++k)
+        ASSERT_NEAR(result[k], threaded[k], 1.0e-12 * result[k]) << k;
+}
+
+TEST(PSDTest, check_tone_power_and_noise_density)
+{
+    auto size = 256u;
+    auto amplitude = 3.0;
+    std::vector<double> tone(size * 16);
+    for (auto i = 0u; i < tone.size(); ++i)
+        tone[i] = amplitude * std::cos(2 * M_PI * 20 * i / size);
+    psd::welch<double> estimator(window::make<double>(window::shape::hann, size), size / 2);
+    auto power = estimator.estimate(tone, 1.0, psd::scaling::spectrum);
+    ASSERT_NEAR(amplitude * amplitude / 2, power[20], 1.0e-9);
+    ASSERT_EQ(20, std::max_element(power.begin(), power.end()) - power.begin());
+
+    //uniform noise on [-1, 1] has variance 1 / 3, spread evenly over [0, rate / 2]
+    auto rate = 100.0;
+    auto noise = generate(size * 512, -1.0, 1.0);
+    auto density = estimator.estimate(noise, rate);
+    auto mean = 0.0;
+    for (auto k = 1u; k + 1 < density.size(); ++k)
+        mean += density[k] / (density.size() - 2);
+    ASSERT_NEAR(2.0 / (3.0 * rate), mean, 0.05 * 2.0 / (3.0 * rate));
+    ASSERT_DOUBLE_EQ(rate / 2, estimator.frequencies(rate).back());
+
+    auto single = psd::periodogram(std::vector<double>(noise.begin(), noise.begin() + size),
+                                   std::vector<double>(size, 1.0), rate);
+    ASSERT_EQ(size / 2 + 1, single.size());
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "sliding.hpp"
+#include "fft.hpp"
+#include "dft.hpp"
+#include "generator.hpp"
+#include <limits>
+
+namespace
+{
+
+template <typename T>
+void check_against_fft(const sliding::dft<T>& tracker, const std::vector<double>& vals,
+                       size_t end, double tolerance)
+{
+    auto size = tracker.size();
+    fft::ComplexVec<double> window(size);
+    for (auto i = 0u; i < size; ++i)
+        window[i] = (end + i >= size) ? vals[end + i - size] : 0.0;
+    auto expected = fft::fft(window);
+    for (auto i = 0u; i < tracker.bins().size(); ++i)
+    {
+        auto value = tracker[i];
+        auto k = tracker.bins()[i];
+        ASSERT_NEAR(expected[k].real(), value.real(), tolerance) << "bin " << k << " after " << end;
+        ASSERT_NEAR(expected[k].imag(), value.imag(), tolerance) << "bin " << k << " after " << end;
+    }
+}
+
+} //namespace
+
+TEST(SlidingDFTTest, check_every_update_vs_fft)
+{
+    auto vals = generate(300);
+    for (auto kind : {sliding::variant::standard, sliding::variant::modulated})
+    {
+        sliding::dft<double> all(32, {}, kind);
+        sliding::dft<double> selected(32, {0, 3, 16, 29}, kind);
+        ASSERT_EQ(17u, all.bins().size());
+        for (auto n = 0u; n < vals.size(); ++n)
+        {
+            all.push(vals[n]);
+            selected.push(vals[n]);
+            ASSERT_NO_FATAL_FAILURE(check_against_fft(all, vals, n + 1, 1.0e-9));
+            ASSERT_NO_FATAL_FAILURE(check_against_fft(selected, vals, n + 1, 1.0e-9));
+        }
+    }
+}
+
+TEST(SlidingDFTTest, check_resync_bounds_drift)
+{
+    auto vals = generate(100000);
+    std::vector<float> samples(vals.begin(), vals.end());
+    for (auto kind : {sliding::variant::standard, sliding::variant::modulated})
+    {
+        sliding::dft<float> tracker(64, {1, 5, 31, 32, 60}, kind, 4096);
+        tracker.push(samples.data(), samples.size());
+        ASSERT_NO_FATAL_FAILURE(check_against_fft(tracker, vals, vals.size(), 0.05));
+
+        sliding::dft<float> synced(64, {1, 5, 31, 32, 60}, kind, std::numeric_limits<size_t>::max());
+        synced.push(samples.data(), samples.size());
+        synced.resync();
+        ASSERT_NO_FATAL_FAILURE(check_against_fft(synced, vals, vals.size(), 0.05));
+        synced.reset();
+        ASSERT_EQ(std::complex<float>(), synced[0]);
+    }
+}
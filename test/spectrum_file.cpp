@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "spectrum_file.hpp"
+#include "fft.hpp"
+#include "dft.hpp"
+#include "generator.hpp"
+#include "equality_checks.hpp"
+#include <cstdio>
+#include <cstddef>
+#include <fstream>
+
+namespace
+{
+
+std::string temporary(const std::string& name)
+{
+    return "/tmp/fft_spectrum_file_" + std::to_string(::getpid()) + "_" + name;
+}
+
+//overwrites part of the header of an existing file
+template <typename T>
+void patch(const std::string& path, size_t offset, T value)
+{
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(offset);
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+} //namespace
+
+TEST(SpectrumFileTest, check_write_and_map_round_trip)
+{
+    auto path = temporary("round_trip");
+    auto spectrum = fft::fft(dft::real2complex(generate(256)));
+    spectrum_file::write(path, spectrum);
+
+    spectrum_file::mapped file(path);
+    ASSERT_EQ(spectrum_file::dtype::complex128, file.type());
+    ASSERT_EQ(spectrum_file::normalization::backward, file.convention());
+    ASSERT_EQ(spectrum_file::layout::row_major, file.order());
+    ASSERT_EQ(std::vector<uint64_t>({256u}), file.shape());
+    ASSERT_EQ(256u, file.size());
+    ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(file.data<double>()) % 4096);
+    fft::ComplexVec<double> loaded(file.data<double>(), file.data<double>() + file.size());
+    ASSERT_NO_FATAL_FAILURE(equal(spectrum, loaded));
+    ASSERT_THROW(file.data<float>(), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(SpectrumFileTest, check_transform_in_place_through_the_mapping)
+{
+    auto path = temporary("in_place");
+    auto width = 16u, height = 8u;
+    auto vals = dft::real2complex(generate(width * height));
+    {
+        auto file = spectrum_file::create<double>(path, {height, width});
+        std::copy(vals.begin(), vals.end(), file.data<double>());
+        fft::fft_2d_in_place(file.data<double>(), width, height);
+    }
+    {
+        //a second mapping sees what the first one wrote
+        spectrum_file::mapped file(path, spectrum_file::mapped::access::read_write);
+        fft::ComplexVec<double> stored(file.data<double>(), file.data<double>() + file.size());
+        ASSERT_NO_FATAL_FAILURE(equal(fft::fft_2d(vals, width), stored));
+        fft::inv_fft_in_place(file.data<double>(), file.size());
+    }
+    spectrum_file::mapped file(path);
+    auto expected = fft::inv_fft(fft::fft_2d(vals, width));
+    fft::ComplexVec<double> stored(file.data<double>(), file.data<double>() + file.size());
+    ASSERT_NO_FATAL_FAILURE(equal(expected, stored));
+    std::remove(path.c_str());
+}
+
+TEST(SpectrumFileTest, check_read_only_mapping_transforms_without_writing)
+{
+    auto path = temporary("copy_on_write");
+    auto vals = dft::real2complex(generate(128));
+    spectrum_file::write(path, vals);
+    {
+        spectrum_file::mapped file(path);
+        fft::fft_in_place(file.data<double>(), file.size());
+        fft::ComplexVec<double> transformed(file.data<double>(), file.data<double>() + file.size());
+        ASSERT_NO_FATAL_FAILURE(equal(fft::fft(vals), transformed));
+    }
+    spectrum_file::mapped file(path);
+    fft::ComplexVec<double> stored(file.data<double>(), file.data<double>() + file.size());
+    ASSERT_NO_FATAL_FAILURE(equal(vals, stored));
+    std::remove(path.c_str());
+}
+
+TEST(SpectrumFileTest, check_invalid_files_are_rejected)
+{
+    auto path = temporary("invalid");
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << std::string(200, 'x');
+    }
+    ASSERT_THROW(spectrum_file::mapped file(path), std::runtime_error);
+
+    fft::ComplexVec<float> values(100);
+    spectrum_file::write(path, values);
+    ASSERT_EQ(100u, spectrum_file::mapped(path).size());
+    ::truncate(path.c_str(), 4096 + 10);
+    ASSERT_THROW(spectrum_file::mapped file(path), std::runtime_error);
+    ASSERT_THROW(spectrum_file::create<double>(path, {}), std::runtime_error);
+
+    //a shape whose element count wraps around to the stored 100 values
+    spectrum_file::write(path, values);
+    patch(path, offsetof(spectrum_file::header, rank), uint32_t(2));
+    patch(path, offsetof(spectrum_file::header, shape), (uint64_t(1) << 62) + 25);
+    patch(path, offsetof(spectrum_file::header, shape) + sizeof(uint64_t), uint64_t(4));
+    ASSERT_THROW(spectrum_file::mapped file(path), std::runtime_error);
+
+    spectrum_file::write(path, values);
+    patch(path, offsetof(spectrum_file::header, layout), uint32_t(7));
+    ASSERT_THROW(spectrum_file::mapped file(path), std::runtime_error);
+    spectrum_file::write(path, values);
+    patch(path, offsetof(spectrum_file::header, normalization), uint32_t(3));
+    ASSERT_THROW(spectrum_file::mapped file(path), std::runtime_error);
+    ASSERT_THROW(spectrum_file::mapped file(temporary("missing")), std::runtime_error);
+    std::remove(path.c_str());
+}
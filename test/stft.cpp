@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include "stft.hpp"
+#include "fft.hpp"
+#include "dft.hpp"
+#include "generator.hpp"
+#include <cmath>
+
+namespace
+{
+
+std::vector<double> hann(size_t size)
+{
+    std::vector<double> ret(size);
+    for (auto i = 0u; i < size; ++i)
+        ret[i] = 0.5 - 0.5 * std::cos(2 * M_PI * i / size);
+    return ret;
+}
+
+} //namespace
+
+TEST(STFTTest, check_real_fft_vs_fft)
+{
+    for (auto size : {2u, 4u, 8u, 64u, 1024u})
+    {
+        auto vals = generate(size);
+        auto expected = fft::fft(dft::real2complex(vals));
+        auto result = fft::real_fft(vals);
+        ASSERT_EQ(size / 2 + 1, result.size());
+        for (auto k = 0u; k < result.size(); ++k)
+        {
+            ASSERT_NEAR(expected[k].real(), result[k].real(), 1.0e-9 * size) << size << " " << k;
+            ASSERT_NEAR(expected[k].imag(), result[k].imag(), 1.0e-9 * size) << size << " " << k;
+        }
+
+        auto back = fft::inv_real_fft(result);
+        ASSERT_EQ(vals.size(), back.size());
+        for (auto i = 0u; i < size; ++i)
+            ASSERT_NEAR(vals[i], back[i], 1.0e-9);
+    }
+}
+
+TEST(STFTTest, check_windowed_zero_padded_frames)
+{
+    auto window = hann(48);
+    stft::engine<double> transform(window, 16, 64);
+    auto vals = generate(200);
+    auto spectrogram = transform.forward(vals);
+    ASSERT_EQ(transform.frames(200) * 33, spectrogram.size());
+    ASSERT_EQ(10u, transform.frames(200));
+
+    for (auto f = 0u; f < transform.frames(200); ++f)
+    {
+        fft::ComplexVec<double> frame(64);
+        for (auto i = 0u; i < 48; ++i)
+            frame[i] = vals[f * 16 + i] * window[i];
+        auto expected = fft::fft(frame);
+        for (auto k = 0u; k < 33; ++k)
+            ASSERT_NEAR(std::abs(expected[k] - spectrogram[f * 33 + k]), 0.0, 1.0e-9);
+    }
+
+    auto threaded = transform.forward(vals, 3);
+    ASSERT_EQ(spectrogram, threaded);
+}
+
+TEST(STFTTest, check_inverse_reconstructs_signal)
+{
+    stft::engine<double> transform(hann(64), 16);
+    auto vals = generate(1000);
+    auto spectrogram = transform.forward(vals);
+    for (auto threads : {1u, 4u})
+    {
+        auto back = transform.inverse(spectrogram, threads);
+        ASSERT_EQ(transform.samples(transform.frames(1000)), back.size());
+        //only the first sample is not covered by the periodic Hann window
+        for (auto i = 1u; i < back.size(); ++i)
+            ASSERT_NEAR(vals[i], back[i], 1.0e-9) << i;
+    }
+}
+
+TEST(STFTTest, check_streaming_matches_batch)
+{
+    stft::engine<double> transform(hann(32), 8);
+    auto vals = generate(500);
+    auto spectrogram = transform.forward(vals);
+    auto expected = transform.inverse(spectrogram);
+
+    stft::analyzer<double> analyze(transform);
+    stft::synthesizer<double> synthesize(transform);
+    fft::ComplexVec<double> streamed;
+    std::vector<double> signal;
+    auto collect = [&](const double* samples, size_t count) {
+        signal.insert(signal.end(), samples, samples + count);
+    };
+    //uneven chunks, some shorter than the hop
+    for (auto pos = 0u, chunk = 1u; pos < vals.size(); pos += chunk, chunk = chunk % 37 + 5)
+    {
+        auto count = std::min<size_t>(chunk, vals.size() - pos);
+        analyze.push(vals.data() + pos, count, [&](const std::complex<double>* bins) {
+            streamed.insert(streamed.end(), bins, bins + transform.bins());
+            synthesize.push(bins, collect);
+        });
+    }
+    synthesize.flush(collect);
+
+    ASSERT_EQ(spectrogram, streamed);
+    ASSERT_EQ(expected.size(), signal.size());
+    for (auto i = 0u; i < signal.size(); ++i)
+        ASSERT_NEAR(expected[i], signal[i], 1.0e-9) << i;
+}
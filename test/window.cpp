@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include "window.hpp"
+#include "fft.hpp"
+#include "dft.hpp"
+#include "generator.hpp"
+#include <cmath>
+
+namespace
+{
+
+//fraction of the energy of the window within |f| < bandwidth
+double concentration(const std::vector<double>& window, double bandwidth)
+{
+    auto inside = 0.0, total = 0.0;
+    for (auto m = 0u; m < window.size(); ++m)
+    {
+        total += window[m] * window[m];
+        for (auto n = 0u; n < window.size(); ++n)
+        {
+            auto d = double(m) - double(n);
+            auto kernel = (m == n) ? 2 * bandwidth : std::sin(2 * M_PI * bandwidth * d) / (M_PI * d);
+            inside += window[m] * window[n] * kernel;
+        }
+    }
+    return inside / total;
+}
+
+} //namespace
+
+TEST(WindowTest, check_known_values)
+{
+    auto hann = window::make<double>(window::shape::hann, 5, 0.0, window::symmetry::symmetric);
+    ASSERT_NEAR(0.0, hann[0], 1.0e-15);
+    ASSERT_NEAR(0.5, hann[1], 1.0e-15);
+    ASSERT_NEAR(1.0, hann[2], 1.0e-15);
+
+    auto periodic = window::make<double>(window::shape::hann, 4);
+    auto expected = window::make<double>(window::shape::hann, 5, 0.0, window::symmetry::symmetric);
+    expected.pop_back();
+    ASSERT_EQ(expected, periodic);
+
+    auto hamming = window::make<double>(window::shape::hamming, 9, 0.0, window::symmetry::symmetric);
+    ASSERT_NEAR(0.08, hamming[0], 1.0e-15);
+    ASSERT_NEAR(1.0, hamming[4], 1.0e-15);
+
+    auto harris = window::make<double>(window::shape::blackman_harris, 9, 0.0, window::symmetry::symmetric);
+    ASSERT_NEAR(6.0e-5, harris[0], 1.0e-15);
+    ASSERT_NEAR(1.0, harris[4], 1.0e-15);
+
+    auto flat = window::make<double>(window::shape::flat_top, 9, 0.0, window::symmetry::symmetric);
+    ASSERT_NEAR(1.0, flat[4], 1.0e-8);
+
+    auto rectangular = window::make<double>(window::shape::kaiser, 7, 0.0);
+    auto tukey = window::make<double>(window::shape::tukey, 7, 0.0);
+    ASSERT_EQ(std::vector<double>(7, 1.0), rectangular);
+    ASSERT_EQ(std::vector<double>(7, 1.0), tukey);
+    auto full_tukey = window::make<double>(window::shape::tukey, 16, 1.0);
+    auto full_hann = window::make<double>(window::shape::hann, 16);
+    for (auto i = 0u; i < 16; ++i)
+        ASSERT_NEAR(full_hann[i], full_tukey[i], 1.0e-15);
+
+    auto kaiser = window::make<double>(window::shape::kaiser, 9, 8.6, window::symmetry::symmetric);
+    ASSERT_NEAR(1.0, kaiser[4], 1.0e-15);
+    ASSERT_NEAR(1.0 / 750.46116, kaiser[0], 1.0e-9);
+}
+
+TEST(WindowTest, check_dpss_is_most_concentrated)
+{
+    auto size = 64u;
+    auto half_bandwidth = 4.0;
+    auto slepian = window::make<double>(window::shape::dpss, size, half_bandwidth, window::symmetry::symmetric);
+    for (auto i = 0u; i < size; ++i)
+        ASSERT_NEAR(slepian[i], slepian[size - 1 - i], 1.0e-12);
+    ASSERT_NEAR(1.0, *std::max_element(slepian.begin(), slepian.end()), 1.0e-12);
+
+    auto bandwidth = half_bandwidth / size;
+    auto best = concentration(slepian, bandwidth);
+    ASSERT_GT(best, 0.999999);
+    for (auto other : {window::shape::hann, window::shape::blackman_harris, window::shape::kaiser})
+    {
+        auto window = window::make<double>(other, size, 12.0, window::symmetry::symmetric);
+        ASSERT_LT(concentration(window, bandwidth), best);
+    }
+}
+
+TEST(WindowTest, check_windows_are_cached)
+{
+    auto& first = window::cached<float>(window::shape::kaiser, 256, 6.0);
+    auto& second = window::cached<float>(window::shape::kaiser, 256, 6.0);
+    auto& other = window::cached<float>(window::shape::kaiser, 256, 7.0);
+    ASSERT_EQ(&first, &second);
+    ASSERT_NE(&first, &other);
+    ASSERT_EQ(window::make<float>(window::shape::kaiser, 256, 6.0), first);
+    ASSERT_EQ(&window::cached<float>(window::shape::hann, 256, 1.0),
+              &window::cached<float>(window::shape::hann, 256));
+}
+
+TEST(WindowTest, check_fused_windowed_transforms)
+{
+    auto size = 256u;
+    auto& taper = window::cached<double>(window::shape::blackman_harris, size);
+    auto vals = generate(size);
+    fft::ComplexVec<double> windowed(size);
+    for (auto i = 0u; i < size; ++i)
+        windowed[i] = vals[i] * taper[i];
+    auto expected = fft::fft(windowed);
+
+    auto result = window::fft(dft::real2complex(vals), taper);
+    auto real = window::real_fft(vals, taper);
+    ASSERT_EQ(size / 2 + 1, real.size());
+    for (auto k = 0u; k < size; ++k)
+    {
+        ASSERT_NEAR(0.0, std::abs(expected[k] - result[k]), 1.0e-9);
+        if (k < real.size())
+        {
+            ASSERT_NEAR(0.0, std::abs(expected[k] - real[k]), 1.0e-9);
+        }
+    }
+}